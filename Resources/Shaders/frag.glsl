@@ -9,31 +9,141 @@ uniform sampler2D texture1;
 uniform sampler2D texture2;
 uniform float mixAmount = 0.2;
 
-uniform vec3 lightPos;
-uniform vec3 viewPos;
-uniform vec3 lightColor = vec3(1.0);
+layout (std140) uniform FrameData
+{
+    mat4 view;
+    mat4 projection;
+    vec4 lightPos;
+    vec4 lightColor;
+    vec4 viewPos;
+};
+
+// Sky irradiance / pi as order-2 spherical harmonics, projected on the CPU
+layout (std140) uniform AmbientData
+{
+    vec4 ambientSH[9];
+};
+
+// Clustered lights: clusterGrid holds (offset, count) into lightIndices for every froxel,
+// lightData four texels per light (see GPULight in LightClusters.h)
+uniform samplerBuffer lightData;
+uniform usamplerBuffer clusterGrid;
+uniform usamplerBuffer lightIndices;
+
+layout (std140) uniform ClusterData
+{
+    uvec4 clusterDims;  // tiles x, tiles y, depth slices, light count
+    vec4 clusterScale;  // tiles per pixel x and y, depth slice scale and bias
+};
+
+// Sun shadow cascades, see CascadedShadowMap
+uniform sampler2DArrayShadow shadowMap;
 
-uniform float ambientStrength = 0.2;
+layout (std140) uniform ShadowData
+{
+    mat4 cascadeViewProjection[4];
+    vec4 cascadeSplits;      // view depth where each cascade ends
+    vec4 cascadeTexelSizes;  // world size of one shadow texel
+    vec4 shadowParams;       // x 1 when the sun casts shadows, y depth bias
+};
+
+uniform float ambientStrength = 1.0; // scale on the sky ambient
 uniform float specularStrength = 0.5;
 uniform float shininess = 32.0;
 
+vec3 evaluateAmbient(vec3 n)
+{
+    return ambientSH[0].rgb * 0.282095
+         + ambientSH[1].rgb * (0.488603 * n.y)
+         + ambientSH[2].rgb * (0.488603 * n.z)
+         + ambientSH[3].rgb * (0.488603 * n.x)
+         + ambientSH[4].rgb * (1.092548 * n.x * n.y)
+         + ambientSH[5].rgb * (1.092548 * n.y * n.z)
+         + ambientSH[6].rgb * (0.315392 * (3.0 * n.z * n.z - 1.0))
+         + ambientSH[7].rgb * (1.092548 * n.x * n.z)
+         + ambientSH[8].rgb * (0.546274 * (n.x * n.x - n.y * n.y));
+}
+
+// Diffuse plus Blinn-Phong specular for one light arriving from direction L
+vec3 shadeLight(vec3 L, vec3 radiance, vec3 norm, vec3 viewDir)
+{
+    float diff = max(dot(norm, L), 0.0);
+    vec3 halfwayDir = normalize(L + viewDir);
+    float spec = pow(max(dot(norm, halfwayDir), 0.0), shininess);
+    return (diff + specularStrength * spec) * radiance;
+}
+
+vec3 shadeClusterLights(vec3 norm, vec3 viewDir, float viewDepth)
+{
+    float slice = max(log(viewDepth) * clusterScale.z + clusterScale.w, 0.0);
+    uvec3 cluster = min(uvec3(uvec2(gl_FragCoord.xy * clusterScale.xy), uint(slice)), clusterDims.xyz - 1u);
+    int clusterIndex = int((cluster.z * clusterDims.y + cluster.y) * clusterDims.x + cluster.x);
+    uvec2 range = texelFetch(clusterGrid, clusterIndex).rg;
+
+    vec3 result = vec3(0.0);
+    for (uint i = 0u; i < range.y; i++) {
+        int light = int(texelFetch(lightIndices, int(range.x + i)).r) * 4;
+        vec4 positionRange = texelFetch(lightData, light);
+        vec3 toLight = positionRange.xyz - FragPos;
+        float dist = length(toLight);
+        if (dist >= positionRange.w) continue;
+
+        // Inverse square, windowed so it reaches zero exactly at the light's range
+        float ratio = dist / positionRange.w;
+        float window = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+        float attenuation = window * window / (dist * dist + 1.0);
+
+        vec3 L = toLight / max(dist, 1e-4);
+        vec4 colorType = texelFetch(lightData, light + 1);
+        if (colorType.w > 0.5) {
+            vec4 directionCosOuter = texelFetch(lightData, light + 2);
+            float cosInner = texelFetch(lightData, light + 3).x;
+            attenuation *= smoothstep(directionCosOuter.w, cosInner, dot(-L, directionCosOuter.xyz));
+        }
+        result += shadeLight(L, colorType.rgb * attenuation, norm, viewDir);
+    }
+    return result;
+}
+
+// Fraction of the sun reaching this pixel: 3x3 taps of the hardware-filtered shadow map
+float sunShadow(vec3 norm, float viewDepth)
+{
+    if (shadowParams.x == 0.0 || viewDepth > cascadeSplits.w) return 1.0;
+
+    int cascade = 0;
+    while (cascade < 3 && viewDepth > cascadeSplits[cascade]) cascade++;
+
+    // Pushing the lookup out along the normal by a texel or so removes acne on slopes
+    vec3 offsetPos = FragPos + norm * (cascadeTexelSizes[cascade] * 1.5);
+    vec4 lightSpace = cascadeViewProjection[cascade] * vec4(offsetPos, 1.0);
+    vec3 coords = lightSpace.xyz / lightSpace.w * 0.5 + 0.5;
+    float reference = coords.z - shadowParams.y;
+
+    vec2 texel = 1.0 / vec2(textureSize(shadowMap, 0).xy);
+    float lit = 0.0;
+    for (int y = -1; y <= 1; y++) {
+        for (int x = -1; x <= 1; x++) {
+            lit += texture(shadowMap, vec4(coords.xy + vec2(x, y) * texel, float(cascade), reference));
+        }
+    }
+    return lit / 9.0;
+}
+
 void main()
 {
     vec3 norm = normalize(Normal);
-    vec3 lightDir = normalize(lightPos - FragPos);
-    vec3 viewDir = normalize(viewPos - FragPos);
-
-    // Ambient
-    vec3 ambient = ambientStrength * lightColor;
+    // w = 0: lightPos holds the direction toward a distant light such as the sun
+    vec3 lightDir = lightPos.w == 0.0 ? normalize(lightPos.xyz) : normalize(lightPos.xyz - FragPos);
+    float viewDepth = -(view * vec4(FragPos, 1.0)).z;
+    vec3 viewDir = normalize(viewPos.xyz - FragPos);
+    vec3 lightCol = lightColor.rgb;
 
-    // Diffuse
-    float diff = max(dot(norm, lightDir), 0.0);
-    vec3 diffuse = diff * lightColor;
+    // Ambient from the sky
+    vec3 ambient = ambientStrength * max(evaluateAmbient(norm), vec3(0.0));
 
-    // Specular (Blinn-Phong)
-    vec3 halfwayDir = normalize(lightDir + viewDir);
-    float spec = pow(max(dot(norm, halfwayDir), 0.0), shininess);
-    vec3 specular = specularStrength * spec * lightColor;
+    // Shadowed sun, then every light binned into this pixel's cluster
+    vec3 direct = shadeLight(lightDir, lightCol, norm, viewDir) * sunShadow(norm, viewDepth);
+    direct += shadeClusterLights(norm, viewDir, viewDepth);
 
     // Texture mixing (corrected)
     vec4 tex1 = texture(texture1, TexCoord);
@@ -41,6 +151,6 @@ void main()
     vec4 mixedTex = mix(tex1, tex2, mixAmount);
     vec3 texColor = mixedTex.rgb;
 
-    vec3 result = (ambient + diffuse + specular) * texColor;
+    vec3 result = (ambient + direct) * texColor;
     FragColor = vec4(result, mixedTex.a);  // Preserve alpha if needed
 }
\ No newline at end of file
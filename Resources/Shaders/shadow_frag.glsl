@@ -0,0 +1,6 @@
+#version 330 core
+
+// Depth only; the shadow targets have no color attachment
+void main()
+{
+}
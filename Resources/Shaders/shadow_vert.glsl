@@ -0,0 +1,11 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 3) in mat4 aModel; // per instance, same layout as vert.glsl
+
+// Light view-projection of the cascade being rendered
+uniform mat4 lightViewProjection;
+
+void main()
+{
+    gl_Position = lightViewProjection * aModel * vec4(aPos, 1.0);
+}
@@ -0,0 +1,13 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+
+out vec3 fragPos;
+
+// 90 degree view of one cubemap face, looking out from the centre of the cube
+uniform mat4 faceViewProjection;
+
+void main()
+{
+    fragPos = aPos;
+    gl_Position = faceViewProjection * vec4(aPos, 1.0);
+}
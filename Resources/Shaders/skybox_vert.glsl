@@ -3,12 +3,19 @@ layout (location = 0) in vec3 aPos;
 
 out vec3 fragPos;
 
-uniform mat4 projection;
-uniform mat4 view;
+layout (std140) uniform FrameData
+{
+    mat4 view;
+    mat4 projection;
+    vec4 lightPos;
+    vec4 lightColor;
+    vec4 viewPos;
+};
 
 void main()
 {
     fragPos = aPos;
-    vec4 pos = projection * view * vec4(aPos, 1.0);
+    // Drop the translation so the sky stays centred on the camera
+    vec4 pos = projection * mat4(mat3(view)) * vec4(aPos, 1.0);
     gl_Position = pos.xyww; // Trick to ensure skybox depth is always 1.0 (furthest)
 }
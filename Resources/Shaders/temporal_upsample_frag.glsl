@@ -0,0 +1,95 @@
+#version 330 core
+out vec4 FragColor;
+in vec2 uv;
+
+// Scene rendered into the bottom-left inputSize pixels of larger textures
+uniform sampler2D sceneColor;
+uniform sampler2D sceneDepth;
+// Previous output, also in the bottom-left outputSize pixels of a larger texture
+uniform sampler2D history;
+
+uniform vec2 inputSize;      // pixels rendered this frame
+uniform vec4 outputSize;     // xy size in pixels, zw 1 / size of the history texture
+uniform vec2 jitter;         // render pixel i was sampled at i + 0.5 + jitter
+uniform mat4 reprojection;   // this frame's clip space to last frame's
+uniform float historyWeight; // 0 when there is no usable history
+
+// Five bilinear taps of a Catmull-Rom filter; keeps the history sharp as it is resampled every frame
+vec3 sampleHistory(vec2 coord)
+{
+    vec2 position = coord * outputSize.xy;
+    vec2 centerPosition = floor(position - 0.5) + 0.5;
+    vec2 f = position - centerPosition;
+
+    vec2 w0 = f * (-0.5 + f * (1.0 - 0.5 * f));
+    vec2 w1 = 1.0 + f * f * (-2.5 + 1.5 * f);
+    vec2 w2 = f * (0.5 + f * (2.0 - 1.5 * f));
+    vec2 w3 = f * f * (-0.5 + 0.5 * f);
+    vec2 w12 = w1 + w2;
+
+    // Keep the taps inside the used corner of the history texture
+    vec2 lowest = 0.5 * outputSize.zw;
+    vec2 highest = (outputSize.xy - 0.5) * outputSize.zw;
+    vec2 tc0 = clamp((centerPosition - 1.0) * outputSize.zw, lowest, highest);
+    vec2 tc3 = clamp((centerPosition + 2.0) * outputSize.zw, lowest, highest);
+    vec2 tc12 = clamp((centerPosition + w2 / w12) * outputSize.zw, lowest, highest);
+
+    vec3 result = texture(history, vec2(tc12.x, tc0.y)).rgb * (w12.x * w0.y)
+                + texture(history, vec2(tc0.x, tc12.y)).rgb * (w0.x * w12.y)
+                + texture(history, tc12).rgb * (w12.x * w12.y)
+                + texture(history, vec2(tc3.x, tc12.y)).rgb * (w3.x * w12.y)
+                + texture(history, vec2(tc12.x, tc3.y)).rgb * (w12.x * w3.y);
+    float weight = w12.x * w0.y + w0.x * w12.y + w12.x * w12.y + w3.x * w12.y + w12.x * w3.y;
+    return max(result / weight, vec3(0.0));
+}
+
+void main()
+{
+    // This output pixel's centre in render pixels
+    vec2 inputPos = uv * inputSize;
+    ivec2 center = ivec2(inputPos);
+    ivec2 maxPixel = ivec2(inputSize) - 1;
+
+    // Gaussian-weighted reconstruction from the jittered samples around the pixel, plus
+    // the neighbourhood's mean and variance for clamping the history
+    vec3 colorSum = vec3(0.0);
+    float weightSum = 0.0;
+    float closestWeight = 0.0;
+    vec3 moment1 = vec3(0.0);
+    vec3 moment2 = vec3(0.0);
+    float closestDepth = 1.0;
+    for (int y = -1; y <= 1; y++) {
+        for (int x = -1; x <= 1; x++) {
+            ivec2 pixel = clamp(center + ivec2(x, y), ivec2(0), maxPixel);
+            vec3 color = texelFetch(sceneColor, pixel, 0).rgb;
+            closestDepth = min(closestDepth, texelFetch(sceneDepth, pixel, 0).r);
+
+            vec2 offset = vec2(pixel) + 0.5 + jitter - inputPos;
+            float weight = exp(-2.29 * dot(offset, offset));
+            colorSum += color * weight;
+            weightSum += weight;
+            closestWeight = max(closestWeight, weight);
+
+            moment1 += color;
+            moment2 += color * color;
+        }
+    }
+    vec3 current = colorSum / max(weightSum, 1e-4);
+
+    // Reproject with the nearest depth around the pixel so edges follow the foreground
+    vec4 previousClip = reprojection * vec4(uv * 2.0 - 1.0, closestDepth * 2.0 - 1.0, 1.0);
+    vec2 previousUV = previousClip.xy / previousClip.w * 0.5 + 0.5;
+    bool offscreen = any(lessThan(previousUV, vec2(0.0))) || any(greaterThan(previousUV, vec2(1.0)));
+    if (historyWeight == 0.0 || previousClip.w <= 0.0 || offscreen) {
+        FragColor = vec4(current, 1.0);
+        return;
+    }
+
+    vec3 mean = moment1 / 9.0;
+    vec3 deviation = sqrt(max(moment2 / 9.0 - mean * mean, vec3(0.0)));
+    vec3 previous = clamp(sampleHistory(previousUV), mean - 1.25 * deviation, mean + 1.25 * deviation);
+
+    // Trust the current frame more when one of its samples landed close to this pixel
+    float currentWeight = mix(0.04, 0.2, closestWeight);
+    FragColor = vec4(mix(previous, current, currentWeight), 1.0);
+}
@@ -1,20 +1,35 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aNormal;
+layout (location = 1) in vec2 aNormalOct;   // octahedral-encoded, snorm16
 layout (location = 2) in vec2 aTexCoord;
+layout (location = 3) in mat4 aModel;        // per instance, occupies 3-6
+layout (location = 7) in mat3 aNormalMatrix; // per instance, occupies 7-9
 
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoord;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+layout (std140) uniform FrameData
+{
+    mat4 view;
+    mat4 projection;
+    vec4 lightPos;
+    vec4 lightColor;
+    vec4 viewPos;
+};
+
+vec3 octDecode(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
 
 void main()
 {
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;
+    FragPos = vec3(aModel * vec4(aPos, 1.0));
+    Normal = aNormalMatrix * octDecode(aNormalOct);
     TexCoord = aTexCoord;
     gl_Position = projection * view * vec4(FragPos, 1.0);
 }
\ No newline at end of file
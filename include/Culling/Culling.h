@@ -0,0 +1,64 @@
+#ifndef CULLING_H
+#define CULLING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "../../src/ThirdParty/glm/glm.hpp"
+
+struct AABB {
+    glm::vec3 min = glm::vec3(0.0f);
+    glm::vec3 max = glm::vec3(0.0f);
+
+    glm::vec3 center() const { return (min + max) * 0.5f; }
+    glm::vec3 extents() const { return (max - min) * 0.5f; }
+};
+
+struct BoundingSphere {
+    glm::vec3 center = glm::vec3(0.0f);
+    float radius = 0.0f;
+};
+
+// Local-space bounds of a mesh, computed once when its vertex data is loaded
+struct MeshBounds {
+    AABB box;
+    BoundingSphere sphere;
+};
+
+// vertexData holds vertexCount vertices of strideFloats floats, position first
+MeshBounds computeMeshBounds(const float* vertexData, size_t vertexCount, size_t strideFloats);
+
+// Box enclosing an AABB after an affine transform
+AABB transformAABB(const AABB& box, const glm::mat4& matrix);
+
+// Slab test against a ray given by origin and reciprocal direction. On a hit within
+// maxDistance, distance receives the entry point (0 when the origin is inside).
+bool intersectRayAABB(const glm::vec3& origin, const glm::vec3& invDir, float maxDistance, const AABB& box, float& distance);
+
+struct Frustum {
+    // left, right, bottom, top, near, far; xyz = inward normal, w = distance
+    glm::vec4 planes[6];
+
+    static Frustum fromMatrix(const glm::mat4& viewProjection);
+};
+
+// Structure-of-arrays box list consumed by the culling kernel
+class AABBList {
+public:
+    std::vector<float> minX, minY, minZ;
+    std::vector<float> maxX, maxY, maxZ;
+
+    void clear();
+    void reserve(size_t count);
+    void push(const AABB& box);
+    // resize() then set() lets threads fill disjoint indices
+    void resize(size_t count);
+    void set(size_t index, const AABB& box);
+    size_t size() const { return minX.size(); }
+};
+
+// Tests every box against the frustum, 8 (AVX) or 4 (SSE) boxes per iteration.
+// visible[i] is set to 1 for boxes that intersect the frustum; returns the visible count.
+size_t cullAABBs(const Frustum& frustum, const AABBList& boxes, uint8_t* visible);
+
+#endif
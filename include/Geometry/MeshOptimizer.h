@@ -0,0 +1,33 @@
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct IndexedMeshData {
+    std::vector<float> vertices;    // strideFloats floats per unique vertex
+    std::vector<uint32_t> indices;  // triangle list
+    size_t strideFloats = 0;
+
+    size_t getVertexCount() const { return strideFloats ? vertices.size() / strideFloats : 0; }
+};
+
+// Merges bit-identical corners of a triangle soup into shared vertices. -0.0 and 0.0
+// are treated as equal so mirrored normals and UVs don't split a vertex.
+IndexedMeshData weldVertices(const float* corners, size_t cornerCount, size_t strideFloats);
+
+// Reorders triangles for the post-transform vertex cache (Forsyth's linear-speed
+// algorithm) so neighbouring triangles reuse recently shaded vertices.
+void optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount);
+
+// Renumbers vertices in first-use order of the index buffer for linear fetches
+void optimizeVertexFetch(IndexedMeshData& mesh);
+
+// Average vertex shader invocations per triangle for a FIFO cache of cacheSize entries
+float computeACMR(const std::vector<uint32_t>& indices, size_t vertexCount, size_t cacheSize = 16);
+
+// Weld, cache-optimize and fetch-optimize in one go
+IndexedMeshData buildIndexedMesh(const float* corners, size_t cornerCount, size_t strideFloats);
+
+#endif
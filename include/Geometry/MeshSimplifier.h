@@ -0,0 +1,26 @@
+#ifndef MESH_SIMPLIFIER_H
+#define MESH_SIMPLIFIER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "MeshOptimizer.h"
+
+struct MeshLodLevel {
+    std::vector<uint32_t> indices;  // into the LOD 0 vertex buffer
+    float error = 0.0f;             // geometric error relative to the mesh extent
+};
+
+// Quadric error metric simplification (Garland & Heckbert) by half-edge collapses,
+// so the result reuses the input's vertices. Open borders are held in place by
+// penalty planes, and corners on attribute seams snap to the closest matching vertex.
+// Stops at targetIndexCount or when no collapse is left that wouldn't flip a triangle.
+std::vector<uint32_t> simplifyMesh(const std::vector<float>& vertices, size_t strideFloats,
+                                   const std::vector<uint32_t>& indices, size_t targetIndexCount,
+                                   float* resultError = nullptr);
+
+// Level 0 is the mesh itself; each ratio adds a coarser level simplified from the
+// previous one. Levels that don't get meaningfully smaller than their parent are dropped.
+std::vector<MeshLodLevel> buildLodChain(const IndexedMeshData& mesh, const std::vector<float>& triangleRatios);
+
+#endif
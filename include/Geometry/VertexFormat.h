@@ -0,0 +1,41 @@
+#ifndef VERTEX_FORMAT_H
+#define VERTEX_FORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "../../src/ThirdParty/glm/glm.hpp"
+
+enum class VertexAttributeType { Float, HalfFloat, SNorm16, UNorm16 };
+
+struct VertexAttribute {
+    unsigned int location;
+    int components;
+    VertexAttributeType type;
+    size_t offset;
+};
+
+// Where each vertex stream lives inside an interleaved vertex. Normals are always two
+// octahedral components; vert.glsl expands them back to a unit vector.
+struct VertexLayout {
+    VertexAttribute position;
+    VertexAttribute normal;
+    VertexAttribute texCoord;
+    size_t stride = 0;
+};
+
+struct PackedVertexData {
+    VertexLayout layout;
+    std::vector<uint8_t> bytes;
+};
+
+// Packs 8-float vertices (position, normal, uv) into the smallest layout the data allows:
+// half positions when half precision is fine for the mesh's size and offset, unorm16 UVs
+// when they stay in [0, 1] (half UVs while half precision stays under a texel, float
+// beyond that), octahedral snorm16 normals.
+PackedVertexData packVertices(const float* vertices, size_t vertexCount);
+
+glm::vec2 octEncode(const glm::vec3& normal);
+glm::vec3 octDecode(const glm::vec2& encoded);
+
+#endif
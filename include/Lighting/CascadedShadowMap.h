@@ -0,0 +1,75 @@
+#ifndef CASCADED_SHADOW_MAP_H
+#define CASCADED_SHADOW_MAP_H
+
+#include "../../src/ThirdParty/glm/glm.hpp"
+#include "../Culling/Culling.h"
+
+class GLStateCache;
+struct ShadowUniforms;
+
+// Sun shadows as a depth texture array with one layer per cascade. Each cascade keeps a
+// second layer with only the static casters; the sampled layer is that cache with the
+// dynamic casters drawn on top. The cache is redrawn only when the sun turns, the
+// cascade moves or invalidateStatic() is called, so a static scene costs no shadow
+// draws at all while the camera stays inside the cascades' guard bands.
+class CascadedShadowMap {
+public:
+    static const int CascadeCount = 4;
+    static const int DefaultResolution = 1024;
+
+    struct Cascade {
+        glm::mat4 viewProjection = glm::mat4(1.0f);
+        glm::vec3 center = glm::vec3(0.0f); // world centre of the sphere the cascade covers
+        float radius = 0.0f;                // includes the guard band
+        float splitDepth = 0.0f;            // view depth where the next cascade takes over
+        float texelSize = 0.0f;             // world size of one shadow texel
+        AABB casterBounds;                  // world box of the cascade volume, toward the sun
+        bool staticDirty = true;
+        bool hasDynamic = false;            // the sampled layer holds dynamic casters
+    };
+
+    explicit CascadedShadowMap(int resolution = DefaultResolution);
+    ~CascadedShadowMap();
+
+    CascadedShadowMap(const CascadedShadowMap&) = delete;
+    CascadedShadowMap& operator=(const CascadedShadowMap&) = delete;
+
+    // Fits the cascades to the camera for a sun shining from sunDirection (pointing at the
+    // sun). A cascade is only re-centred when its frustum slice leaves the padded sphere it
+    // was last fitted to; the new centre is snapped to whole shadow texels so static
+    // shadows don't shimmer.
+    void update(const glm::mat4& view, const glm::mat4& projection, float nearPlane, float shadowDistance,
+                const glm::vec3& sunDirection);
+
+    // Call when a static caster was added, removed, moved or changed its static flag
+    void invalidateStatic();
+
+    // Binds the cascade's static cache layer, cleared, for the static casters
+    void beginStaticPass(GLStateCache& state, int cascade);
+    void endStaticPass(int cascade);
+
+    // Copies the static cache into the sampled layer and leaves that bound for the dynamic
+    // casters. Only needed when the cache changed or dynamic casters were or are present.
+    void beginCompositePass(GLStateCache& state, int cascade, bool hasDynamicCasters);
+
+    const Cascade& getCascade(int cascade) const { return cascades[cascade]; }
+    void fillUniforms(ShadowUniforms& uniforms) const;
+
+    unsigned int getTexture() const { return shadowTexture; }
+    int getResolution() const { return resolution; }
+
+private:
+    int resolution;
+    unsigned int shadowTexture = 0;   // sampled by frag.glsl
+    unsigned int staticTexture = 0;   // static casters only
+    unsigned int shadowFramebuffer = 0;
+    unsigned int staticFramebuffer = 0;
+
+    Cascade cascades[CascadeCount];
+    glm::vec3 sunDirection = glm::vec3(0.0f);
+
+    unsigned int createDepthArray(bool sampled);
+    void fitCascade(Cascade& cascade, const glm::vec3& sliceCenter, float sliceRadius, bool sunChanged);
+};
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef LIGHT_CLUSTERS_H
+#define LIGHT_CLUSTERS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "../../src/ThirdParty/glm/glm.hpp"
+#include "../Culling/Culling.h"
+#include "../Threading/JobSystem.h"
+
+enum class LightType {
+    Point = 0,
+    Spot = 1
+};
+
+// One light as the shader reads it: four RGBA32F texels of the light data buffer
+struct GPULight {
+    glm::vec4 positionRange;     // xyz world position, w distance where the light reaches zero
+    glm::vec4 colorType;         // rgb color * intensity, w LightType
+    glm::vec4 directionCosOuter; // xyz spot direction, w cos of the outer cone angle
+    glm::vec4 cosInner;          // x cos of the inner cone angle
+};
+
+// Spheres in view space with depth measured along -z, stored for the binning kernel
+struct LightSphereList {
+    std::vector<float> x, y, depth, radius;
+    std::vector<uint32_t> index;
+
+    void clear();
+    void push(float px, float py, float pdepth, float pradius, uint32_t lightIndex);
+    size_t size() const { return x.size(); }
+};
+
+// Froxel grid for clustered forward shading: TilesX * TilesY screen tiles, each split
+// into Slices exponentially spaced depth slices. Every frame build() lists the lights
+// touching each cluster, so a pixel only loops over the lights near it.
+//
+// Binning is hierarchical: a light is tested against its depth slice, then the tile row,
+// then each cluster in the row, so the work follows how many lights overlap each cluster
+// rather than lights * clusters. Slices are split across workers and each test runs 8
+// (AVX) or 4 (SSE) lights at a time.
+class LightClusterGrid {
+public:
+    static const int TilesX = 16;
+    static const int TilesY = 9;
+    static const int Slices = 24;
+    static const int ClusterCount = TilesX * TilesY * Slices;
+
+    // Below this many lights the binning runs on the calling thread
+    static const size_t ParallelLightThreshold = 64;
+
+    // Rebuilds the cluster boxes when the projection changed. Expects a symmetric
+    // perspective projection such as glm::perspective.
+    void setProjection(const glm::mat4& projection, float nearPlane, float farPlane);
+
+    // Bins the lights against the frustum seen through view, on the job system's workers
+    // when one is given
+    void build(const std::vector<GPULight>& lights, const glm::mat4& view, JobSystem* jobs = nullptr);
+
+    // Two values per cluster, offset into getLightIndices() and light count. Clusters are
+    // ordered x fastest, then tile row, then slice.
+    const std::vector<uint32_t>& getClusterRanges() const { return clusterRanges; }
+    const std::vector<uint32_t>& getLightIndices() const { return lightIndices; }
+
+    // slice = floor(log(viewDepth) * sliceScale + sliceBias)
+    float getSliceScale() const { return sliceScale; }
+    float getSliceBias() const { return sliceBias; }
+    int getMaxLightsPerCluster() const { return maxLightsPerCluster; }
+
+private:
+    struct SliceWork {
+        LightSphereList sliceLights;
+        LightSphereList rowLights;
+        std::vector<uint32_t> indices;
+        int maxLights = 0;
+    };
+
+    glm::mat4 cachedProjection = glm::mat4(0.0f);
+    float nearPlane = 0.0f;
+    float farPlane = 0.0f;
+    float sliceScale = 0.0f;
+    float sliceBias = 0.0f;
+
+    std::vector<AABB> sliceBoxes;   // per slice, the whole frustum cross-section
+    std::vector<AABB> rowBoxes;     // per slice and tile row
+    std::vector<AABB> clusterBoxes; // per cluster
+
+    LightSphereList spheres;
+    std::vector<SliceWork> work;    // one per slice range
+    std::vector<uint32_t> clusterRanges;
+    std::vector<uint32_t> lightIndices;
+    int maxLightsPerCluster = 0;
+
+    void binSlices(int firstSlice, int endSlice, SliceWork& scratch);
+};
+
+// Appends the spheres of in that overlap box to out
+void filterLightSpheres(const LightSphereList& in, const AABB& box, LightSphereList& out);
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef SPHERICAL_HARMONICS_H
+#define SPHERICAL_HARMONICS_H
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+#include "../../src/ThirdParty/glm/glm.hpp"
+#include "../Threading/JobSystem.h"
+
+// Order-2 (9 coefficient) real spherical harmonics, one RGB coefficient per basis function
+struct SH9 {
+    glm::vec3 coefficients[9];
+};
+
+// Projects a radiance function onto SH9 by integrating over a fixed, evenly spread set
+// of directions. The directions and their basis values are computed once, so each call
+// only evaluates the radiance and runs the multiply-add kernel (AVX or SSE) over the
+// samples, split across the job system's workers.
+class SHProjector {
+public:
+    static const int DefaultSampleCount = 4096;
+
+    using RadianceFunction = std::function<glm::vec3(const glm::vec3& direction)>;
+
+    explicit SHProjector(int sampleCount = DefaultSampleCount);
+
+    // With jobs, radiance is called concurrently from several threads and must not write
+    // shared state
+    SH9 project(const RadianceFunction& radiance, JobSystem* jobs = nullptr);
+
+    int getSampleCount() const { return static_cast<int>(sampleCount); }
+
+private:
+    size_t sampleCount = 0;
+    size_t paddedCount = 0;              // rounded up to the SIMD width; padding has zero basis
+    std::vector<glm::vec3> directions;
+    std::vector<float> basis;            // 9 rows of paddedCount values
+    std::vector<float> radianceR, radianceG, radianceB;
+
+    void projectRange(size_t begin, size_t end, const RadianceFunction& radiance, SH9& result);
+};
+
+// Convolves radiance with the clamped cosine lobe and divides by pi, giving the light a
+// white Lambertian surface reflects for each normal direction
+SH9 convolveLambertian(const SH9& radiance);
+
+glm::vec3 evaluateSH9(const SH9& sh, const glm::vec3& direction);
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef CPU_PROFILER_H
+#define CPU_PROFILER_H
+
+#include <cstdint>
+#include <string>
+
+// Scoped CPU timing markers. Every thread records into its own ring buffer of
+// EventsPerThread events without taking a lock; the oldest events are overwritten.
+// writeChromeTrace() snapshots all threads and writes the recent events as
+// Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev).
+//
+// Use the PROFILE_* macros below rather than the classes. Without MODULARITY_PROFILING
+// they compile to nothing.
+class CpuProfiler {
+public:
+    static constexpr uint32_t EventsPerThread = 1u << 16;
+
+    // Nanoseconds since the profiler's epoch
+    static uint64_t now();
+
+    // name must outlive the profiler: a string literal or __func__
+    static void record(const char* name, uint64_t start, uint64_t end);
+
+    // Label for the calling thread's lane in the trace
+    static void setThreadName(const char* name);
+
+    // Writes every event that ended within the last `seconds`. Returns false when the
+    // file can't be written.
+    static bool writeChromeTrace(const std::string& path, double seconds, size_t* eventsWritten = nullptr);
+};
+
+class CpuProfileScope {
+public:
+    explicit CpuProfileScope(const char* name) : name(name), start(CpuProfiler::now()) {}
+    ~CpuProfileScope() { CpuProfiler::record(name, start, CpuProfiler::now()); }
+
+    CpuProfileScope(const CpuProfileScope&) = delete;
+    CpuProfileScope& operator=(const CpuProfileScope&) = delete;
+
+private:
+    const char* name;
+    uint64_t start;
+};
+
+#define MODULARITY_PROFILE_JOIN2(a, b) a##b
+#define MODULARITY_PROFILE_JOIN(a, b) MODULARITY_PROFILE_JOIN2(a, b)
+
+#ifdef MODULARITY_PROFILING
+#define PROFILE_SCOPE(name) CpuProfileScope MODULARITY_PROFILE_JOIN(cpuProfileScope, __LINE__)(name)
+#define PROFILE_THREAD_NAME(name) CpuProfiler::setThreadName(name)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_THREAD_NAME(name) ((void)0)
+#endif
+
+#endif
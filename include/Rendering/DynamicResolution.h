@@ -0,0 +1,54 @@
+#ifndef DYNAMIC_RESOLUTION_H
+#define DYNAMIC_RESOLUTION_H
+
+// Chooses the fraction of the viewport the scene is rendered at from the GPU time the
+// viewport took. The time comes from GL_TIME_ELAPSED queries that are read back a few
+// frames late, so measuring never stalls on the GPU.
+class DynamicResolution {
+public:
+    static constexpr float MinScale = 0.5f;
+    static constexpr float MaxScale = 1.0f;
+    static constexpr float DefaultBudget = 16.6f;  // milliseconds
+    static const int QueryCount = 4;
+
+    DynamicResolution();
+    ~DynamicResolution();
+
+    DynamicResolution(const DynamicResolution&) = delete;
+    DynamicResolution& operator=(const DynamicResolution&) = delete;
+
+    // Brackets the GPU work the scale controls. A frame goes unmeasured when every query
+    // is still in flight.
+    void beginTiming();
+    void endTiming();
+
+    // Reads back finished queries and moves the scale toward the budget. Call before
+    // getScale() for the frame.
+    void update();
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return enabled; }
+    void setBudget(float milliseconds);
+    float getBudget() const { return budget; }
+
+    // Fraction of the viewport width and height to render at; MaxScale when disabled
+    float getScale() const { return enabled ? scale : MaxScale; }
+    // Most recent measured GPU time in milliseconds, 0 before the first result
+    float getGpuTime() const { return gpuTime; }
+
+private:
+    unsigned int queries[QueryCount];
+    float queryScales[QueryCount];  // scale each pending query measured
+    int nextQuery = 0;
+    int pendingCount = 0;
+    bool timing = false;
+
+    bool enabled = true;
+    float budget = DefaultBudget;
+    float scale = MaxScale;
+    float gpuTime = 0.0f;
+
+    void adjust(float measuredScale, float milliseconds);
+};
+
+#endif
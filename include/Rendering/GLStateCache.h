@@ -0,0 +1,58 @@
+#ifndef GL_STATE_CACHE_H
+#define GL_STATE_CACHE_H
+
+// CPU copy of the GL bindings the renderer changes every frame. Each setter only
+// reaches GL when the value differs from the cached one and counts the calls it saved.
+// Code that changes these bindings behind the cache's back must call invalidate().
+//
+// The renderer never reads GL state back; builds with MODULARITY_GL_VALIDATION can
+// cross-check the shadow copy against glGet queries with validate().
+class GLStateCache {
+public:
+    static constexpr unsigned int MaxTextureUnits = 16;
+
+    GLStateCache() { invalidate(); }
+
+    void useProgram(unsigned int program);
+    void bindVertexArray(unsigned int vertexArray);
+    void bindArrayBuffer(unsigned int buffer);
+    // Supports GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY, GL_TEXTURE_CUBE_MAP and GL_TEXTURE_BUFFER;
+    // other targets are passed through
+    void bindTexture(unsigned int unit, unsigned int target, unsigned int texture);
+    void setDepthFunc(unsigned int func);
+    void bindFramebuffer(unsigned int framebuffer);
+
+    // Forget everything; the next call of each setter always reaches GL
+    void invalidate();
+
+    void resetCounters() { issuedCount = 0; skippedCount = 0; }
+    int getIssuedCount() const { return issuedCount; }
+    int getSkippedCount() const { return skippedCount; }
+
+    // Queries GL for every binding the cache knows and reports mismatches on std::cerr,
+    // then invalidates so the next binds repair the state. Returns true when all matched.
+    // Always true without MODULARITY_GL_VALIDATION, and never touches GL in that case.
+    bool validate();
+
+private:
+    static constexpr unsigned int Unknown = 0xFFFFFFFFu;
+
+    unsigned int program = Unknown;
+    unsigned int vertexArray = Unknown;
+    unsigned int arrayBuffer = Unknown;
+    unsigned int activeUnit = Unknown;
+    unsigned int textures2D[MaxTextureUnits];
+    unsigned int texturesCube[MaxTextureUnits];
+    unsigned int texturesBuffer[MaxTextureUnits];
+    unsigned int texturesArray[MaxTextureUnits];
+    unsigned int depthFunc = Unknown;
+    unsigned int framebuffer = Unknown;
+
+    int issuedCount = 0;
+    int skippedCount = 0;
+
+    bool changed(unsigned int& cached, unsigned int value);
+    void activeTexture(unsigned int unit);
+};
+
+#endif
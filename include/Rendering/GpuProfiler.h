@@ -0,0 +1,105 @@
+#ifndef GPU_PROFILER_H
+#define GPU_PROFILER_H
+
+#include <string>
+#include <vector>
+
+// Per-pass GPU times from glQueryCounter timestamps. Scopes may nest and may be opened
+// anywhere between beginFrame() and endFrame(). Each frame's queries are read back
+// FrameLatency frames later, and only once the GPU has finished them; a frame that is
+// still in flight when its queries are needed again is dropped rather than waited for.
+//
+// Query objects are created on first use, so the profiler can be constructed before
+// there is a GL context.
+class GpuProfiler {
+public:
+    static constexpr int FrameLatency = 3;
+    static constexpr int HistoryLength = 240;
+
+    struct PassHistory {
+        std::string name;
+        float samples[HistoryLength] = {};  // milliseconds, a ring starting at next
+        int next = 0;
+        int count = 0;
+        float latest = 0.0f;
+    };
+
+    struct PassStats {
+        float average = 0.0f;
+        float p50 = 0.0f;
+        float p95 = 0.0f;
+        float p99 = 0.0f;
+        float max = 0.0f;
+    };
+
+    GpuProfiler() = default;
+    ~GpuProfiler();
+
+    GpuProfiler(const GpuProfiler&) = delete;
+    GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+    // Nothing is recorded while disabled; the history is kept
+    void setEnabled(bool enable) { enabled = enable; }
+    bool isEnabled() const { return enabled; }
+
+    // Reads back every finished frame, then starts recording a new one
+    void beginFrame();
+    void endFrame();
+
+    // Returns a handle for endScope(), or -1 when not recording
+    int beginScope(const char* name);
+    void endScope(int scope);
+
+    // Passes in the order they were first seen. The whole frame, from beginFrame() to
+    // endFrame(), is always the first entry.
+    const std::vector<PassHistory>& getPasses() const { return passes; }
+    PassStats computeStats(const PassHistory& pass) const;
+    int getDroppedFrameCount() const { return droppedFrames; }
+
+private:
+    struct Scope {
+        int pass;
+        int beginQuery;
+        int endQuery = -1;
+    };
+    struct Frame {
+        std::vector<unsigned int> queries;  // grows as needed and is reused
+        int usedQueries = 0;
+        std::vector<Scope> scopes;
+        bool pending = false;
+    };
+
+    Frame frames[FrameLatency];
+    int current = 0;
+    bool enabled = true;
+    bool recording = false;
+    int frameScope = -1;
+    int droppedFrames = 0;
+
+    std::vector<PassHistory> passes;
+    std::vector<float> frameTimes;       // per pass, accumulated while reading a frame
+    mutable std::vector<float> sorted;   // scratch for percentiles
+
+    int findPass(const char* name);
+    int timestamp(Frame& frame);
+    bool readFrame(Frame& frame);
+};
+
+// Times the enclosing block; does nothing when profiler is null
+class GpuProfileScope {
+public:
+    GpuProfileScope(GpuProfiler* profiler, const char* name)
+        : profiler(profiler), scope(profiler ? profiler->beginScope(name) : -1) {}
+    ~GpuProfileScope() {
+        if (profiler) profiler->endScope(scope);
+    }
+
+    GpuProfileScope(const GpuProfileScope&) = delete;
+    GpuProfileScope& operator=(const GpuProfileScope&) = delete;
+
+private:
+    GpuProfiler* profiler;
+    int scope;
+};
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 64-bit draw sort key, most significant field first:
+//   pass (4) | shader (10) | texture set (12) | vertex array (14) | depth (24)
+// Sorting by the key groups draws by the state that is most expensive to change and
+// orders each group front to back.
+namespace RenderKey {
+    constexpr int PassBits = 4;
+    constexpr int ShaderBits = 10;
+    constexpr int TextureSetBits = 12;
+    constexpr int VertexArrayBits = 14;
+    constexpr int DepthBits = 24;
+
+    // depth is normalized to [0, 1]; out-of-range values are clamped
+    uint64_t make(unsigned int pass, unsigned int shader, unsigned int textureSet, unsigned int vertexArray, float depth);
+    unsigned int pass(uint64_t key);
+}
+
+struct RenderCommand {
+    uint64_t key;
+    uint32_t payload;  // index into the submitter's own draw list
+};
+
+class RenderQueue {
+public:
+    void clear() { commands.clear(); }
+    void reserve(size_t count) { commands.reserve(count); }
+    void push(uint64_t key, uint32_t payload) { commands.push_back({ key, payload }); }
+
+    // Stable LSD radix sort on the key, one byte per pass; bytes that are the same in
+    // every key are skipped, so a frame with few distinct states sorts in a pass or two
+    void sort();
+
+    const std::vector<RenderCommand>& getCommands() const { return commands; }
+    size_t size() const { return commands.size(); }
+
+private:
+    std::vector<RenderCommand> commands;
+    std::vector<RenderCommand> scratch;
+};
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef RENDER_TARGET_POOL_H
+#define RENDER_TARGET_POOL_H
+
+#include <memory>
+#include <vector>
+#include "../../src/ThirdParty/glm/glm.hpp"
+
+class GLStateCache;
+
+// What a target holds. A zero format leaves that attachment out.
+struct RenderTargetDesc {
+    unsigned int colorFormat = 0;  // sized internal format, e.g. GL_RGB8 or GL_RGBA16F
+    unsigned int depthFormat = 0;  // GL_DEPTH24_STENCIL8 or GL_DEPTH_COMPONENT24
+
+    bool operator==(const RenderTargetDesc& other) const {
+        return colorFormat == other.colorFormat && depthFormat == other.depthFormat;
+    }
+};
+
+// Framebuffer with texture attachments, allocated at a bucketed size
+struct RenderTarget {
+    RenderTargetDesc desc;
+    unsigned int framebuffer = 0;
+    unsigned int colorTexture = 0;
+    unsigned int depthTexture = 0;
+    int width = 0;
+    int height = 0;
+    bool inUse = false;
+    unsigned long long lastUsedFrame = 0;
+};
+
+// The corner of a target a pass renders into this frame: set the viewport to
+// width x height and sample the result up to uvScale
+struct RenderTargetView {
+    const RenderTarget* target = nullptr;
+    int width = 0;
+    int height = 0;
+    glm::vec2 uvScale = glm::vec2(1.0f);
+};
+
+// Render targets shared by every pass. Sizes are rounded up to whole buckets and a pass
+// draws into the lower-left corner it needs, so most size changes cost nothing.
+//
+// Passes that keep a target across frames (the viewport, history buffers) use a slot.
+// A slot only moves to a different bucket once the requested size has held for
+// StableFrames frames. Until then it keeps its target and renders at most the target's
+// size, so dragging a dock splitter reallocates once when the drag ends instead of
+// every frame. Passes that need scratch space within a frame use acquire() and release().
+//
+// Targets no pass used for FreeAfterFrames frames are deleted in beginFrame().
+class RenderTargetPool {
+public:
+    static const int BucketSize = 128;
+    static const int StableFrames = 10;
+    static const int FreeAfterFrames = 120;
+
+    RenderTargetPool() = default;
+    ~RenderTargetPool();
+
+    RenderTargetPool(const RenderTargetPool&) = delete;
+    RenderTargetPool& operator=(const RenderTargetPool&) = delete;
+
+    void beginFrame(GLStateCache& state);
+
+    int createSlot(const RenderTargetDesc& desc);
+    // The target for this frame's width x height request. The view may be smaller than
+    // the request while the size is settling.
+    RenderTargetView resolveSlot(GLStateCache& state, int slot, int width, int height);
+    // True once the slot's target is in the bucket of its last requested size, so the view
+    // covers the whole request. Until then keep resolving the slot every frame, or it never
+    // counts the StableFrames it needs to move.
+    bool isSlotSettled(int slot) const;
+
+    // A free target of at least width x height for use within the frame
+    RenderTargetView acquire(GLStateCache& state, const RenderTargetDesc& desc, int width, int height);
+    void release(const RenderTarget* target);
+
+    size_t getTargetCount() const { return targets.size(); }
+    int getAllocationCount() const { return allocationCount; }
+
+private:
+    struct Slot {
+        RenderTargetDesc desc;
+        RenderTarget* target = nullptr;
+        int requestedWidth = 0;
+        int requestedHeight = 0;
+        int stableFrames = 0;
+    };
+
+    std::vector<std::unique_ptr<RenderTarget>> targets;
+    std::vector<Slot> slots;
+    unsigned long long frameIndex = 0;
+    int allocationCount = 0;
+
+    static int bucket(int size);
+    RenderTarget* findOrCreate(GLStateCache& state, const RenderTargetDesc& desc, int width, int height);
+    void allocate(GLStateCache& state, RenderTarget& target);
+    static void destroy(RenderTarget& target);
+    RenderTargetView makeView(RenderTarget* target, int width, int height);
+};
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef TEMPORAL_UPSAMPLER_H
+#define TEMPORAL_UPSAMPLER_H
+
+#include "../../src/ThirdParty/glm/glm.hpp"
+#include "RenderTargetPool.h"
+
+class Shader;
+class GLStateCache;
+
+// Rebuilds the full-size viewport image from scene frames rendered at a lower, varying
+// resolution with a sub-pixel jitter. Each output pixel blends a filtered sample of the
+// current frame with the previous output, reprojected through the camera using the
+// scene depth. The history is clamped to the current frame's neighbourhood so moving
+// objects and disocclusions don't leave trails.
+class TemporalUpsampler {
+public:
+    static const int JitterSequenceLength = 8;
+    // Frames a still image needs after a change before the history has converged
+    static const int ConvergenceFrames = 4 * JitterSequenceLength;
+
+    // The two history buffers are slots in the pool. Throws when the shader doesn't build.
+    explicit TemporalUpsampler(RenderTargetPool& pool);
+    ~TemporalUpsampler();
+
+    TemporalUpsampler(const TemporalUpsampler&) = delete;
+    TemporalUpsampler& operator=(const TemporalUpsampler&) = delete;
+
+    // The next resolve uses only the current frame, e.g. after a camera cut. Changing
+    // the output size does this too.
+    void resetHistory() { historyValid = false; }
+
+    // Sub-pixel offset for the frame, in render target pixels within [-0.5, 0.5)
+    static glm::vec2 getJitter(unsigned long long frameIndex);
+    // Shifts the projection by jitter pixels of a renderWidth x renderHeight target
+    static glm::mat4 jitterProjection(const glm::mat4& projection, const glm::vec2& jitter, int renderWidth, int renderHeight);
+
+    // Resolves the rendered corner of the scene target into an outputWidth x outputHeight
+    // image in the next history buffer. viewProjection is the camera's unjittered matrix
+    // for this frame. Leaves the output framebuffer bound.
+    void resolve(GLStateCache& state, const RenderTargetView& scene, int outputWidth, int outputHeight,
+                 const glm::vec2& jitter, const glm::mat4& viewProjection);
+
+    // The image of the latest resolve
+    const RenderTargetView& getOutput() const { return history[current]; }
+
+private:
+    RenderTargetPool& pool;
+    int historySlots[2] = { -1, -1 };
+    RenderTargetView history[2];
+
+    Shader* shader = nullptr;
+    int inputSizeLocation = -1;
+    int outputSizeLocation = -1;
+    int jitterLocation = -1;
+    int reprojectionLocation = -1;
+    int historyWeightLocation = -1;
+
+    unsigned int emptyVAO = 0;  // the fullscreen triangle is generated from gl_VertexID
+    int current = 0;
+    bool historyValid = false;
+    glm::mat4 previousViewProjection = glm::mat4(1.0f);
+};
+
+#endif
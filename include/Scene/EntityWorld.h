@@ -0,0 +1,257 @@
+#ifndef ENTITY_WORLD_H
+#define ENTITY_WORLD_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "SlotMap.h"
+#include "../Threading/JobSystem.h"
+
+// An entity is a slot in the world's entity table: it stops resolving once destroyed
+using Entity = SlotHandle;
+// Bit n set when the component with id n is present
+typedef uint64_t ComponentMask;
+
+// How the world constructs, moves and destroys a component it only knows by id
+struct ComponentInfo {
+    size_t size = 0;
+    size_t align = 0;
+    void (*moveConstruct)(void* destination, void* source) = nullptr;
+    void (*destroy)(void* component) = nullptr;
+};
+
+class ComponentRegistry {
+public:
+    static const int MaxComponents = 64;
+
+    static int add(const ComponentInfo& info);
+    static const ComponentInfo& get(int id);
+};
+
+// Ids are handed out the first time each type is used, so they differ between runs
+template <typename T>
+int componentId() {
+    static_assert(std::is_move_constructible<T>::value, "Components must be movable");
+    static_assert(alignof(T) <= alignof(std::max_align_t), "Over-aligned components are not supported");
+    static const int id = ComponentRegistry::add({
+        sizeof(T), alignof(T),
+        [](void* destination, void* source) { new (destination) T(std::move(*static_cast<T*>(source))); },
+        [](void* component) { static_cast<T*>(component)->~T(); }
+    });
+    return id;
+}
+
+template <typename... Ts>
+ComponentMask componentMask() {
+    return (ComponentMask(0) | ... | (ComponentMask(1) << componentId<std::remove_const_t<Ts>>()));
+}
+
+// Entities grouped by their exact set of components. Each group, an archetype, stores its
+// entities in fixed-size chunks with one array per component, so a system that reads two
+// components streams exactly those two arrays. Chunks are kept packed: removing an entity
+// moves the archetype's last one into its row.
+//
+// Queries are cached per component set and extended as archetypes appear, so iterating
+// costs nothing per archetype that can't match. Adding or removing a component moves the
+// entity to another archetype; component pointers are only valid until the next
+// structural change (create, destroy, add, remove). Entities stay in creation order in
+// the entity table, so entityAt() walks them in that order.
+class EntityWorld {
+public:
+    static const size_t ChunkBytes = 16 * 1024;
+    // Queries over fewer entities run on the calling thread
+    static const size_t ParallelThreshold = 4096;
+
+    struct Chunk {
+        std::unique_ptr<unsigned char[]> data;
+        size_t count = 0;
+    };
+
+    struct Archetype {
+        ComponentMask mask = 0;
+        std::vector<int> components;                 // ids, ascending
+        std::vector<size_t> columnOffsets;           // byte offset of each component's array
+        int columnOf[ComponentRegistry::MaxComponents];  // index into components, or -1
+        size_t capacity = 0;                         // rows per chunk
+        size_t chunkBytes = 0;
+        std::vector<Chunk> chunks;                   // all full except the last
+        size_t entityCount = 0;
+        std::unordered_map<int, Archetype*> edges;   // archetype with that component toggled
+
+        Archetype() = default;
+        Archetype(const Archetype&) = delete;
+        Archetype& operator=(const Archetype&) = delete;
+        ~Archetype() { destroyRows(); }
+
+        Entity* entities(Chunk& chunk) const { return reinterpret_cast<Entity*>(chunk.data.get()); }
+        void* component(Chunk& chunk, int column, size_t row) const {
+            return chunk.data.get() + columnOffsets[column] + row * ComponentRegistry::get(components[column]).size;
+        }
+        void destroyRows();
+    };
+
+    template <typename... Ts>
+    Entity create(Ts... components) {
+        Archetype& archetype = getArchetype(componentMask<Ts...>());
+        Entity entity = allocate(archetype);
+        const Location& location = *entities.get(entity);
+        Chunk& chunk = archetype.chunks[location.chunk];
+        (new (archetype.component(chunk, archetype.columnOf[componentId<Ts>()], location.row)) Ts(std::move(components)), ...);
+        return entity;
+    }
+
+    void destroy(Entity entity);
+    // Destroys every entity; archetypes and cached queries are kept
+    void clear();
+
+    bool isAlive(Entity entity) const { return entities.contains(entity); }
+    size_t size() const { return entities.size(); }
+    Entity entityAt(size_t index) const { return entities.handleAt(index); }
+    int indexOf(Entity entity) const { return entities.indexOf(entity); }
+
+    // Replaces the component if the entity already has one
+    template <typename T>
+    T* add(Entity entity, T component) {
+        int id = componentId<T>();
+        Location* location = entities.get(entity);
+        if (!location) return nullptr;
+        if (T* existing = get<T>(entity)) {
+            *existing = std::move(component);
+            return existing;
+        }
+
+        Archetype& target = getNeighbour(*location->archetype, id);
+        move(entity, target);
+        Chunk& chunk = target.chunks[location->chunk];
+        return new (target.component(chunk, target.columnOf[id], location->row)) T(std::move(component));
+    }
+
+    template <typename T>
+    bool remove(Entity entity) {
+        int id = componentId<T>();
+        Location* location = entities.get(entity);
+        if (!location || location->archetype->columnOf[id] < 0) return false;
+        move(entity, getNeighbour(*location->archetype, id));
+        return true;
+    }
+
+    template <typename T>
+    T* get(Entity entity) {
+        return static_cast<T*>(find(entity, componentId<T>()));
+    }
+    template <typename T>
+    const T* get(Entity entity) const {
+        return static_cast<const T*>(const_cast<EntityWorld*>(this)->find(entity, componentId<T>()));
+    }
+    template <typename T>
+    bool has(Entity entity) const {
+        const Location* location = entities.get(entity);
+        return location && location->archetype->columnOf[componentId<T>()] >= 0;
+    }
+
+    // Entities that have at least the given components
+    template <typename... Ts>
+    size_t count() const {
+        size_t total = 0;
+        for (const Archetype* archetype : query(componentMask<Ts...>())) total += archetype->entityCount;
+        return total;
+    }
+
+    // fn(size_t first, size_t count, const Entity* entities, Ts*... columns) once per chunk
+    // of every entity with at least the components Ts. first counts the rows of the
+    // chunks before, so results can go to a flat array sized by count<Ts...>().
+    template <typename... Ts, typename Fn>
+    void eachChunk(Fn&& fn) {
+        size_t first = 0;
+        for (Archetype* archetype : query(componentMask<Ts...>())) {
+            for (Chunk& chunk : archetype->chunks) {
+                callChunk<Ts...>(fn, *archetype, chunk, first);
+                first += chunk.count;
+            }
+        }
+    }
+    template <typename... Ts, typename Fn>
+    void eachChunk(Fn&& fn) const {
+        const_cast<EntityWorld*>(this)->eachChunk<const Ts...>(fn);
+    }
+
+    // fn(Entity, Ts&...) for every entity with at least the components Ts
+    template <typename... Ts, typename Fn>
+    void each(Fn&& fn) {
+        eachChunk<Ts...>([&fn](size_t, size_t count, const Entity* chunkEntities, Ts*... columns) {
+            for (size_t i = 0; i < count; i++) fn(chunkEntities[i], columns[i]...);
+        });
+    }
+    template <typename... Ts, typename Fn>
+    void each(Fn&& fn) const {
+        const_cast<EntityWorld*>(this)->each<const Ts...>(fn);
+    }
+
+    // eachChunk() with the chunks split across the job system's workers; fn must only
+    // touch its own rows. Runs on the calling thread without jobs.
+    template <typename... Ts, typename Fn>
+    void parallelEachChunk(Fn&& fn, JobSystem* jobs) {
+        struct Task { Archetype* archetype; Chunk* chunk; size_t first; };
+        std::vector<Task> tasks;
+        size_t total = 0;
+        for (Archetype* archetype : query(componentMask<Ts...>())) {
+            for (Chunk& chunk : archetype->chunks) {
+                tasks.push_back({ archetype, &chunk, total });
+                total += chunk.count;
+            }
+        }
+
+        parallelFor(total < ParallelThreshold ? nullptr : jobs, tasks.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t t = begin; t < end; t++) callChunk<Ts...>(fn, *tasks[t].archetype, *tasks[t].chunk, tasks[t].first);
+        });
+    }
+    template <typename... Ts, typename Fn>
+    void parallelEachChunk(Fn&& fn, JobSystem* jobs) const {
+        const_cast<EntityWorld*>(this)->parallelEachChunk<const Ts...>(fn, jobs);
+    }
+
+    size_t getArchetypeCount() const { return archetypes.size(); }
+
+private:
+    struct Location {
+        Archetype* archetype = nullptr;
+        uint32_t chunk = 0;
+        uint32_t row = 0;
+    };
+
+    SlotMap<Location> entities;
+    std::vector<std::unique_ptr<Archetype>> archetypes;
+    std::unordered_map<ComponentMask, Archetype*> archetypesByMask;
+    // Built on first use. Not thread safe: run a query once on the main thread before
+    // using it from workers.
+    mutable std::unordered_map<ComponentMask, std::vector<Archetype*>> queries;
+
+    Archetype& getArchetype(ComponentMask mask);
+    Archetype& getNeighbour(Archetype& archetype, int component);
+    const std::vector<Archetype*>& query(ComponentMask mask) const;
+    void* find(Entity entity, int component);
+
+    // Reserves a row in the archetype for a new entity; its components are not constructed
+    Entity allocate(Archetype& archetype);
+    // Moves the entity's components into the target archetype. Components the target lacks
+    // are destroyed; ones only the target has are left for the caller to construct.
+    void move(Entity entity, Archetype& target);
+    void reserveRow(Archetype& archetype, uint32_t& chunk, uint32_t& row);
+    // Fills the row with the archetype's last entity, whose components are moved
+    void removeRow(Archetype& archetype, uint32_t chunk, uint32_t row);
+
+    template <typename... Ts, typename Fn>
+    static void callChunk(Fn& fn, Archetype& archetype, Chunk& chunk, size_t first) {
+        if (chunk.count == 0) return;
+        fn(first, chunk.count, const_cast<const Entity*>(archetype.entities(chunk)),
+           static_cast<Ts*>(archetype.component(chunk, archetype.columnOf[componentId<std::remove_const_t<Ts>>()], 0))...);
+    }
+};
+
+#endif
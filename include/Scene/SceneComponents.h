@@ -0,0 +1,80 @@
+#ifndef SCENE_COMPONENTS_H
+#define SCENE_COMPONENTS_H
+
+#include <string>
+#include <vector>
+#include "../../src/ThirdParty/glm/glm.hpp"
+
+// Components of the editor's scene objects, stored in an EntityWorld. Every object has
+// ObjectInfo and Transform; the rest only where the object needs them.
+
+enum class ObjectType {
+    Cube,
+    Sphere,
+    Capsule,
+    OBJMesh,  // New type for loaded OBJ models
+    PointLight,
+    SpotLight
+};
+
+inline bool isMeshType(ObjectType type) {
+    return type == ObjectType::Cube || type == ObjectType::Sphere || type == ObjectType::Capsule ||
+           type == ObjectType::OBJMesh;
+}
+
+inline bool isLightType(ObjectType type) {
+    return type == ObjectType::PointLight || type == ObjectType::SpotLight;
+}
+
+// What the editor and the scene file know an object by
+struct ObjectInfo {
+    int id = -1;
+    std::string name;
+    ObjectType type = ObjectType::Cube;
+    bool isExpanded = true;  // in the hierarchy panel
+};
+
+// Relative to the parent. The world matrix lives in the engine's TransformHierarchy.
+struct Transform {
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::vec3 rotation = glm::vec3(0.0f);  // XYZ Euler angles in degrees
+    glm::vec3 scale = glm::vec3(1.0f);
+    int node = -1;                         // TransformHierarchy node, -1 while untracked
+};
+
+// Only on objects that have a parent or children
+struct Hierarchy {
+    int parentId = -1;
+    std::vector<int> childIds;
+};
+
+// What the renderer draws. The type is repeated here so drawing never reads ObjectInfo.
+struct MeshRef {
+    ObjectType type = ObjectType::Cube;  // Cube, Sphere, Capsule or OBJMesh
+    int meshId = -1;                     // index into the loaded OBJ meshes
+};
+
+// Where an OBJMesh object's mesh was loaded from
+struct MeshFile {
+    std::string path;
+};
+
+// Leaf in the engine's scene AABBTree; on every object with a MeshRef
+struct SpatialProxy {
+    int node = -1;  // -1 while untracked
+};
+
+// Spot lights shine along their local -Y axis
+struct Light {
+    glm::vec3 color = glm::vec3(1.0f);
+    float intensity = 5.0f;
+    float range = 10.0f;
+    float spotInnerAngle = 20.0f;  // degrees from the axis
+    float spotOuterAngle = 30.0f;
+    bool spot = false;
+};
+
+// Never moves while the scene runs; its shadows are cached
+struct StaticTag {};
+
+#endif
@@ -0,0 +1,122 @@
+#ifndef SLOT_MAP_H
+#define SLOT_MAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Refers to a value in a SlotMap. Once the value is erased the handle stops resolving,
+// even after its slot is reused, because the slot's generation has moved on.
+struct SlotHandle {
+    static constexpr uint32_t InvalidIndex = 0xFFFFFFFFu;
+
+    uint32_t index = InvalidIndex;
+    uint32_t generation = 0;
+
+    bool isValid() const { return index != InvalidIndex; }
+    bool operator==(const SlotHandle& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const SlotHandle& other) const { return !(*this == other); }
+};
+
+// Values live in one contiguous array in insertion order, so they can be iterated and
+// passed on as a std::vector. Handles resolve to them through a slot array in O(1).
+//
+// Erasing keeps the remaining values in order, so it moves every value after the erased
+// one down and costs O(n). Pointers and indices into values() are only valid until the
+// next insert or erase; handles stay valid until their own value is erased.
+template <typename T>
+class SlotMap {
+public:
+    SlotHandle insert(T value) {
+        uint32_t slotIndex;
+        if (freeHead != SlotHandle::InvalidIndex) {
+            slotIndex = freeHead;
+            freeHead = slots[slotIndex].nextFree;
+        } else {
+            slotIndex = static_cast<uint32_t>(slots.size());
+            slots.emplace_back();
+        }
+
+        Slot& slot = slots[slotIndex];
+        slot.valueIndex = static_cast<uint32_t>(dense.size());
+        dense.push_back(std::move(value));
+        denseSlots.push_back(slotIndex);
+        return { slotIndex, slot.generation };
+    }
+
+    bool erase(SlotHandle handle) {
+        if (!contains(handle)) return false;
+
+        Slot& slot = slots[handle.index];
+        uint32_t valueIndex = slot.valueIndex;
+        dense.erase(dense.begin() + valueIndex);
+        denseSlots.erase(denseSlots.begin() + valueIndex);
+        for (size_t i = valueIndex; i < denseSlots.size(); i++) {
+            slots[denseSlots[i]].valueIndex = static_cast<uint32_t>(i);
+        }
+
+        release(handle.index);
+        return true;
+    }
+
+    // Every outstanding handle stops resolving
+    void clear() {
+        for (uint32_t slotIndex : denseSlots) release(slotIndex);
+        dense.clear();
+        denseSlots.clear();
+    }
+
+    void reserve(size_t count) {
+        dense.reserve(count);
+        denseSlots.reserve(count);
+        slots.reserve(count);
+    }
+
+    bool contains(SlotHandle handle) const {
+        return handle.index < slots.size() && slots[handle.index].generation == handle.generation &&
+               slots[handle.index].valueIndex != SlotHandle::InvalidIndex;
+    }
+
+    T* get(SlotHandle handle) { return contains(handle) ? &dense[slots[handle.index].valueIndex] : nullptr; }
+    const T* get(SlotHandle handle) const { return contains(handle) ? &dense[slots[handle.index].valueIndex] : nullptr; }
+
+    // Position of the handle's value in values(), or -1
+    int indexOf(SlotHandle handle) const {
+        return contains(handle) ? static_cast<int>(slots[handle.index].valueIndex) : -1;
+    }
+    SlotHandle handleAt(size_t index) const { return { denseSlots[index], slots[denseSlots[index]].generation }; }
+
+    const std::vector<T>& values() const { return dense; }
+    T& operator[](size_t index) { return dense[index]; }
+    const T& operator[](size_t index) const { return dense[index]; }
+    typename std::vector<T>::iterator begin() { return dense.begin(); }
+    typename std::vector<T>::iterator end() { return dense.end(); }
+    typename std::vector<T>::const_iterator begin() const { return dense.begin(); }
+    typename std::vector<T>::const_iterator end() const { return dense.end(); }
+
+    size_t size() const { return dense.size(); }
+    bool empty() const { return dense.empty(); }
+
+private:
+    struct Slot {
+        uint32_t valueIndex = SlotHandle::InvalidIndex;  // InvalidIndex while free
+        uint32_t generation = 0;
+        uint32_t nextFree = SlotHandle::InvalidIndex;
+    };
+
+    std::vector<T> dense;
+    std::vector<uint32_t> denseSlots;  // slot of each value
+    std::vector<Slot> slots;
+    uint32_t freeHead = SlotHandle::InvalidIndex;
+
+    void release(uint32_t slotIndex) {
+        Slot& slot = slots[slotIndex];
+        slot.valueIndex = SlotHandle::InvalidIndex;
+        slot.generation++;
+        slot.nextFree = freeHead;
+        freeHead = slotIndex;
+    }
+};
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef TRANSFORM_HIERARCHY_H
+#define TRANSFORM_HIERARCHY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "../../src/ThirdParty/glm/glm.hpp"
+#include "../Threading/JobSystem.h"
+
+// Local translation, rotation and scale of every scene node, kept as separate arrays in
+// depth-first order: each node is followed by its whole subtree, so parents come before
+// their children and every root's subtree is one contiguous range.
+//
+// Editing a node marks it dirty. update() recomputes the world matrices of the dirty
+// nodes and their descendants in a single pass over the arrays, splitting large
+// hierarchies across job workers at root boundaries, and lists the nodes whose world matrix
+// changed. Clean subtrees cost one flag test per node.
+//
+// Nodes are named by ids that stay valid until destroyNode(); where a node sits in the
+// arrays changes whenever the hierarchy is restructured.
+class TransformHierarchy {
+public:
+    static const int NullNode = -1;
+    // Smaller hierarchies are updated on the calling thread
+    static const int ParallelThreshold = 8192;
+
+    // New nodes are dirty. userData is handed back by getUserData(), e.g. an object id.
+    int createNode(int userData, const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale,
+                   int parent = NullNode);
+    // The node's children move up to its parent and keep their local transforms
+    void destroyNode(int node);
+    void clear();
+
+    // Keeps the local transform, so the subtree moves with its new parent. Returns false
+    // when parent is the node itself or one of its descendants.
+    bool setParent(int node, int parent);
+    int getParent(int node) const { return parentNodes[indexOfNode[node]]; }
+    bool isDescendant(int node, int ancestor) const;
+
+    // rotation is XYZ Euler angles in degrees, as for compose()
+    void setLocal(int node, const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale);
+
+    // Large hierarchies are split across the job system's workers when one is given
+    void update(JobSystem* jobs = nullptr);
+    // Nodes whose world matrix was recomputed by the last update()
+    const std::vector<int>& getChangedNodes() const { return changedNodes; }
+    // How far the node's world origin moved the last time its matrix was recomputed
+    const glm::vec3& getDisplacement(int node) const { return displacements[indexOfNode[node]]; }
+
+    // Valid as of the last update()
+    const glm::mat4& getWorldMatrix(int node) const { return worldMatrices[indexOfNode[node]]; }
+    // Identity for roots
+    glm::mat4 getParentWorldMatrix(int node) const;
+    int getUserData(int node) const { return userData[indexOfNode[node]]; }
+    size_t getNodeCount() const { return nodeAt.size(); }
+
+    // translate * rotateX * rotateY * rotateZ * scale, with the angles in degrees
+    static glm::mat4 compose(const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale);
+    // Inverse of compose() for matrices without shear
+    static void decompose(const glm::mat4& matrix, glm::vec3& position, glm::vec3& rotation, glm::vec3& scale);
+
+private:
+    // Indexed by position in depth-first order
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> rotations;
+    std::vector<glm::vec3> scales;
+    std::vector<glm::mat4> worldMatrices;
+    std::vector<glm::vec3> displacements;
+    std::vector<int> parentNodes;
+    std::vector<int> subtreeSizes;   // counting the node itself
+    std::vector<int> nodeAt;
+    std::vector<int> userData;
+    std::vector<uint8_t> dirty;
+
+    std::vector<int> indexOfNode;    // by node id; -1 for free ids
+    std::vector<int> freeNodes;
+    std::vector<int> parentIndices;  // position of each parent, rebuilt when the structure changes
+    bool structureChanged = false;
+    bool anyDirty = false;
+
+    std::vector<int> changedNodes;
+    std::vector<std::vector<int>> rangeChangedNodes;
+
+    void updateRange(size_t begin, size_t end, std::vector<int>& changed);
+    void insertAt(size_t index, int node, int nodeUserData, const glm::vec3& position, const glm::vec3& rotation,
+                  const glm::vec3& scale, int parent);
+    void eraseAt(size_t index);
+    void rotateRange(size_t first, size_t middle, size_t last);
+    void reindex(size_t first, size_t last);
+    void addToAncestors(int parent, int count);
+};
+
+#endif
@@ -2,6 +2,7 @@
 #define SHADER_H
 
 #include <string>
+#include <unordered_map>
 #include "../../ThirdParty/glm/glm.hpp"
 
 class Shader
@@ -19,7 +20,23 @@ public:
     void setVec3(const std::string &name, const glm::vec3 &value) const;
     void setMat4(const std::string &name, const glm::mat4 &mat) const;
 
+    // Locations come from the table built after linking; -1 when the uniform is inactive.
+    // Cache them for per-object uniforms and use the location overloads below.
+    int getUniformLocation(const std::string &name) const;
+    void setInt(int location, int value) const;
+    void setFloat(int location, float value) const;
+    void setVec2(int location, const glm::vec2 &value) const;
+    void setVec3(int location, const glm::vec3 &value) const;
+    void setVec4(int location, const glm::vec4 &value) const;
+    void setMat4(int location, const glm::mat4 &mat) const;
+
+    // Attaches a named uniform block to a binding point shared with a UniformBuffer
+    void bindUniformBlock(const char* blockName, unsigned int bindingPoint) const;
+
 private:
+    std::unordered_map<std::string, int> uniformLocations;
+
+    void reflectUniforms();
     std::string readShaderFile(const char* filePath);
     void compileShaders(const char* vertexSource, const char* fragmentSource);
     void checkCompileErrors(unsigned int shader, std::string type);
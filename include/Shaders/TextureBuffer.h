@@ -0,0 +1,35 @@
+#ifndef TEXTURE_BUFFER_H
+#define TEXTURE_BUFFER_H
+
+#include <cstddef>
+
+class GLStateCache;
+
+// Buffer object exposed to shaders as a samplerBuffer/usamplerBuffer, for per-frame
+// arrays too large or too variable in size for a uniform block.
+class TextureBuffer
+{
+public:
+    // internalFormat is the texel format the shader reads, e.g. GL_RGBA32F or GL_R32UI
+    explicit TextureBuffer(unsigned int internalFormat);
+    ~TextureBuffer();
+
+    TextureBuffer(const TextureBuffer&) = delete;
+    TextureBuffer& operator=(const TextureBuffer&) = delete;
+
+    // Replaces the contents. The storage is orphaned each call so the upload never waits
+    // on draws still reading last frame's data; it only grows.
+    void update(const void* data, size_t size);
+
+    // Binds the buffer texture to a unit through the state cache
+    void bind(GLStateCache& state, unsigned int unit) const;
+
+    unsigned int getTexture() const { return texture; }
+
+private:
+    unsigned int buffer = 0;
+    unsigned int texture = 0;
+    size_t capacity = 0;
+};
+
+#endif
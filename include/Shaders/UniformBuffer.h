@@ -0,0 +1,68 @@
+#ifndef UNIFORM_BUFFER_H
+#define UNIFORM_BUFFER_H
+
+#include <cstddef>
+#include "../../src/ThirdParty/glm/glm.hpp"
+
+// Binding points shared by every program that declares the matching block
+constexpr unsigned int FRAME_UNIFORM_BINDING = 0;
+constexpr unsigned int AMBIENT_UNIFORM_BINDING = 1;
+constexpr unsigned int CLUSTER_UNIFORM_BINDING = 2;
+constexpr unsigned int SHADOW_UNIFORM_BINDING = 3;
+
+// std140 mirror of the FrameData block in vert.glsl, frag.glsl and skybox_vert.glsl.
+// vec3 values are stored as vec4 so the C++ and GLSL layouts match without padding.
+struct FrameUniforms {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::vec4 lightPos;
+    glm::vec4 lightColor;
+    glm::vec4 viewPos;
+};
+static_assert(sizeof(FrameUniforms) == 176, "FrameUniforms must match the std140 FrameData block");
+
+// std140 mirror of the AmbientData block in frag.glsl: SH9 sky irradiance already
+// divided by pi, rgb in xyz. Only re-uploaded when the sky changes.
+struct AmbientUniforms {
+    glm::vec4 sh[9];
+};
+static_assert(sizeof(AmbientUniforms) == 144, "AmbientUniforms must match the std140 AmbientData block");
+
+// std140 mirror of the ClusterData block in frag.glsl, describing the froxel grid the
+// light lists were binned into
+struct ClusterUniforms {
+    glm::uvec4 dims;   // tiles x, tiles y, depth slices, light count
+    glm::vec4 scale;   // tiles per pixel x and y, depth slice scale and bias
+};
+static_assert(sizeof(ClusterUniforms) == 32, "ClusterUniforms must match the std140 ClusterData block");
+
+// std140 mirror of the ShadowData block in frag.glsl: the sun's shadow cascades
+struct ShadowUniforms {
+    glm::mat4 cascadeViewProjection[4];
+    glm::vec4 cascadeSplits;     // view depth where each cascade ends
+    glm::vec4 cascadeTexelSizes; // world size of one shadow texel, for the normal offset
+    glm::vec4 params;            // x 1 when the sun casts shadows, y depth bias
+};
+static_assert(sizeof(ShadowUniforms) == 304, "ShadowUniforms must match the std140 ShadowData block");
+
+class UniformBuffer
+{
+public:
+    UniformBuffer(size_t size, unsigned int bindingPoint);
+    ~UniformBuffer();
+
+    UniformBuffer(const UniformBuffer&) = delete;
+    UniformBuffer& operator=(const UniformBuffer&) = delete;
+
+    void update(const void* data, size_t size, size_t offset = 0);
+
+    unsigned int getID() const { return ID; }
+    unsigned int getBindingPoint() const { return binding; }
+
+private:
+    unsigned int ID = 0;
+    size_t size = 0;
+    unsigned int binding = 0;
+};
+
+#endif
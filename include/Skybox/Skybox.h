@@ -1,23 +1,69 @@
 #ifndef SKYBOX_H
 #define SKYBOX_H
 
+#include "../../src/ThirdParty/glm/glm.hpp"
+
 class Shader;
+class GLStateCache;
 
+// Procedural sky baked into a cubemap. The expensive sky shader only runs when the time
+// of day changes; drawing the sky every frame is a single cubemap lookup per pixel.
 class Skybox {
+public:
+    static const int BakeResolution = 1024;   // per face; stars are about one texel wide
+    static const int PreviewResolution = 128; // used while the time of day is being dragged
+
 private:
     unsigned int VAO, VBO;
-    Shader* skyboxShader;
+    Shader* skyboxShader;  // samples the baked cubemap
+    Shader* bakeShader;    // evaluates the procedural sky, one face at a time
+    int timeOfDayLocation = -1;
+    int faceViewProjectionLocation = -1;
     float timeOfDay = 0.5f; // 0.0 = night, 0.25 = sunrise, 0.5 = day, 0.75 = sunset, 1.0 = midnight
 
+    unsigned int bakeFramebuffer = 0;
+    unsigned int cubemap = 0;
+    unsigned int previewCubemap = 0; // created on the first interactive edit
+    bool dirty = true;
+    bool editing = false;
+    bool showingPreview = false;
+    bool previewWhileEditing = true;
+    int bakeCount = 0;
+
     void setupMesh();
+    unsigned int createCubemap(int resolution);
+    void bakeFaces(GLStateCache& state, unsigned int target, int resolution);
 
 public:
     Skybox();
     ~Skybox();
     
-    void draw(const float* view, const float* projection);
-    void setTimeOfDay(float time); // 0.0 to 1.0
+    // Re-renders the sky into its cubemap if the time of day changed since the last bake.
+    // Binds its own framebuffer and viewport, so call it before the viewport target is
+    // bound. Returns true when a bake happened.
+    bool updateBake(GLStateCache& state);
+
+    // View and projection come from the shared FrameData uniform block. The caller sets
+    // the depth test to GL_LEQUAL so the sky passes at the far plane.
+    void draw(GLStateCache& state);
+
+    // 0.0 to 1.0. Pass interactive while a slider is held: with preview enabled the sky is
+    // re-baked at PreviewResolution until a non-interactive call restores full detail.
+    void setTimeOfDay(float time, bool interactive = false);
     float getTimeOfDay() const { return timeOfDay; }
+
+    // Unit vector toward the sun, and the sun's light (zero once it has set), matching
+    // the sun drawn by skybox_bake_frag.glsl
+    static glm::vec3 getSunDirection(float timeOfDay);
+    static glm::vec3 getSunColor(float timeOfDay);
+
+    // CPU copy of the sky gradient and sun from skybox_bake_frag.glsl, for lighting that
+    // is derived from the sky. Stars are left out; they add nothing visible to ambient.
+    static glm::vec3 evaluateSky(const glm::vec3& direction, float timeOfDay);
+
+    void setPreviewWhileEditing(bool enabled) { previewWhileEditing = enabled; }
+    bool getPreviewWhileEditing() const { return previewWhileEditing; }
+    int getBakeCount() const { return bakeCount; }
 };
 
 #endif
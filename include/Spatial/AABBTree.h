@@ -0,0 +1,73 @@
+#ifndef AABB_TREE_H
+#define AABB_TREE_H
+
+#include <cstddef>
+#include <vector>
+#include "../Culling/Culling.h"
+
+struct RayHit {
+    int userData;
+    float distance;  // entry distance along the ray into the proxy's fat box
+};
+
+// Dynamic bounding volume tree over fattened AABBs (in the style of Box2D's b2DynamicTree).
+// Leaves are inserted with a surface-area cost heuristic and the tree is kept balanced
+// with AVL rotations, so moving a few proxies per frame only touches O(log n) nodes.
+class AABBTree {
+public:
+    static constexpr int NullNode = -1;
+
+    explicit AABBTree(float margin = 0.1f);
+
+    // Returns a proxy id that stays valid until destroyProxy()
+    int createProxy(const AABB& box, int userData);
+    void destroyProxy(int proxyId);
+
+    // Refits a proxy after its object moved. Nothing changes while the new box is still
+    // inside the fat box; otherwise the leaf is reinserted with the box enlarged along
+    // the displacement. Returns true when the tree was modified.
+    bool moveProxy(int proxyId, const AABB& box, const glm::vec3& displacement = glm::vec3(0.0f));
+
+    int getUserData(int proxyId) const { return nodes[proxyId].userData; }
+    void setUserData(int proxyId, int userData) { nodes[proxyId].userData = userData; }
+    const AABB& getFatAABB(int proxyId) const { return nodes[proxyId].box; }
+
+    void clear();
+    size_t getProxyCount() const { return proxyCount; }
+    int getHeight() const { return root == NullNode ? 0 : nodes[root].height; }
+
+    // Queries append the user data of every proxy whose fat box passes the test
+    void queryFrustum(const Frustum& frustum, std::vector<int>& results) const;
+    void queryBox(const AABB& box, std::vector<int>& results) const;
+    void querySphere(const glm::vec3& center, float radius, std::vector<int>& results) const;
+    // Hits are sorted front to back
+    void queryRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, std::vector<RayHit>& results) const;
+
+private:
+    struct Node {
+        AABB box;
+        int parent = NullNode;  // doubles as the next free node while on the free list
+        int child1 = NullNode;
+        int child2 = NullNode;
+        int height = -1;        // 0 for leaves, -1 for free nodes
+        int userData = -1;
+
+        bool isLeaf() const { return child1 == NullNode; }
+    };
+
+    std::vector<Node> nodes;
+    int root = NullNode;
+    int freeList = NullNode;
+    size_t proxyCount = 0;
+    float margin;
+
+    int allocateNode();
+    void freeNode(int nodeId);
+    void insertLeaf(int leaf);
+    void removeLeaf(int leaf);
+    int balance(int nodeId);
+    void refitUpwards(int nodeId);
+    void collectLeaves(int nodeId, std::vector<int>& results, std::vector<int>& stack) const;
+};
+
+#endif
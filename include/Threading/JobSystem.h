@@ -0,0 +1,120 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobSystem;
+struct Job;
+
+// Refers to a scheduled job; a default-constructed handle counts as done
+class JobHandle {
+public:
+    bool isValid() const { return job != nullptr; }
+    bool isDone() const;
+
+private:
+    friend class JobSystem;
+    std::shared_ptr<Job> job;
+};
+
+// A fixed pool of worker threads with one deque each. A worker pushes and pops jobs at the
+// back of its own deque and, when that is empty, steals from the front of the others, so
+// recently split work stays on the thread whose cache holds it. The thread that created
+// the pool is the main (GL) thread: it never becomes a worker, but jobs marked for it are
+// queued until it calls runMainThreadTasks().
+//
+// A job starts once all of its dependencies are done. Threads that wait, in wait() or
+// parallelFor(), run other jobs meanwhile, so waiting from inside a job can't deadlock the
+// pool. Jobs must not throw.
+class JobSystem {
+public:
+    typedef std::function<void()> Task;
+    typedef std::function<void(size_t begin, size_t end)> RangeFunction;
+
+    // workerCount 0 uses every hardware thread but the main one, and at least one
+    explicit JobSystem(unsigned int workerCount = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // Runs the queued jobs and restarts with a different pool size, 0 as in the constructor.
+    // Main thread only, outside any parallelFor().
+    void setWorkerCount(unsigned int workerCount);
+    unsigned int getWorkerCount() const { return static_cast<unsigned int>(workers.size()); }
+
+    JobHandle schedule(Task task, const std::vector<JobHandle>& dependencies = {});
+    // Runs on the main thread in runMainThreadTasks(), after the dependencies
+    JobHandle runOnMainThread(Task task, const std::vector<JobHandle>& dependencies = {});
+
+    // Runs other jobs until the job is done. Don't wait on a main-thread job from a worker.
+    void wait(const JobHandle& handle);
+
+    // fn(begin, end) over [0, count) in ranges of grainSize, spread over the workers and the
+    // calling thread. Returns once every range is done.
+    void parallelFor(size_t count, size_t grainSize, const RangeFunction& fn);
+
+    // Runs the main-thread jobs that are ready; returns how many ran. Called once per frame.
+    size_t runMainThreadTasks();
+    bool hasMainThreadTasks() const;
+    // Called from any thread when a main-thread job becomes ready, so a sleeping editor
+    // loop can wake up to run it
+    void setMainThreadWakeup(std::function<void()> wakeup) { mainThreadWakeup = std::move(wakeup); }
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<std::shared_ptr<Job>> jobs;
+    };
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::atomic<size_t> nextQueue{ 0 };
+    std::atomic<size_t> queuedJobs{ 0 };
+
+    // Idle workers sleep on workAvailable, threads in wait() on jobDone
+    std::mutex sleepMutex;
+    std::condition_variable workAvailable;
+    std::condition_variable jobDone;
+    std::atomic<int> sleepingWorkers{ 0 };
+    std::atomic<int> waitingThreads{ 0 };
+    bool stopping = false;
+
+    mutable std::mutex mainThreadMutex;
+    std::vector<std::shared_ptr<Job>> mainThreadJobs;
+    std::function<void()> mainThreadWakeup;
+    std::thread::id mainThreadId;
+
+    static unsigned int resolveWorkerCount(unsigned int workerCount);
+    void start(unsigned int workerCount);
+    void stop();
+    void workerLoop(size_t index);
+
+    JobHandle submit(Task task, bool mainThread, const std::vector<JobHandle>& dependencies);
+    // Drops one pending dependency and queues the job once none are left
+    void release(const std::shared_ptr<Job>& job);
+    void enqueue(const std::shared_ptr<Job>& job);
+    void execute(const std::shared_ptr<Job>& job);
+    // Pops from the calling worker's own deque, else steals. False when every deque is empty.
+    bool runOneJob();
+    void notifyWaiters();
+};
+
+// parallelFor() on the pool, or on the calling thread when there is none
+inline void parallelFor(JobSystem* jobs, size_t count, size_t grainSize, const JobSystem::RangeFunction& fn) {
+    if (jobs) {
+        jobs->parallelFor(count, grainSize, fn);
+    } else if (count > 0) {
+        fn(0, count);
+    }
+}
+
+#endif
@@ -0,0 +1,186 @@
+#include "../../include/Culling/Culling.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define CULLING_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CULLING_SSE 1
+#endif
+
+MeshBounds computeMeshBounds(const float* vertexData, size_t vertexCount, size_t strideFloats) {
+    MeshBounds bounds;
+    if (!vertexData || vertexCount == 0) return bounds;
+
+    glm::vec3 lo(vertexData[0], vertexData[1], vertexData[2]);
+    glm::vec3 hi = lo;
+    for (size_t i = 1; i < vertexCount; i++) {
+        const float* v = vertexData + i * strideFloats;
+        glm::vec3 p(v[0], v[1], v[2]);
+        lo = glm::min(lo, p);
+        hi = glm::max(hi, p);
+    }
+    bounds.box.min = lo;
+    bounds.box.max = hi;
+
+    // Sphere around the box centre, tightened to the farthest actual vertex
+    glm::vec3 center = bounds.box.center();
+    float radiusSq = 0.0f;
+    for (size_t i = 0; i < vertexCount; i++) {
+        const float* v = vertexData + i * strideFloats;
+        glm::vec3 d = glm::vec3(v[0], v[1], v[2]) - center;
+        radiusSq = std::max(radiusSq, glm::dot(d, d));
+    }
+    bounds.sphere.center = center;
+    bounds.sphere.radius = std::sqrt(radiusSq);
+    return bounds;
+}
+
+AABB transformAABB(const AABB& box, const glm::mat4& matrix) {
+    // Arvo: transform the centre, project the extents onto the absolute basis
+    glm::vec3 center = glm::vec3(matrix * glm::vec4(box.center(), 1.0f));
+    glm::vec3 extents = box.extents();
+
+    glm::vec3 worldExtents(
+        std::abs(matrix[0][0]) * extents.x + std::abs(matrix[1][0]) * extents.y + std::abs(matrix[2][0]) * extents.z,
+        std::abs(matrix[0][1]) * extents.x + std::abs(matrix[1][1]) * extents.y + std::abs(matrix[2][1]) * extents.z,
+        std::abs(matrix[0][2]) * extents.x + std::abs(matrix[1][2]) * extents.y + std::abs(matrix[2][2]) * extents.z
+    );
+
+    AABB result;
+    result.min = center - worldExtents;
+    result.max = center + worldExtents;
+    return result;
+}
+
+bool intersectRayAABB(const glm::vec3& origin, const glm::vec3& invDir, float maxDistance, const AABB& box, float& distance) {
+    glm::vec3 t0 = (box.min - origin) * invDir;
+    glm::vec3 t1 = (box.max - origin) * invDir;
+    glm::vec3 tNear = glm::min(t0, t1);
+    glm::vec3 tFar = glm::max(t0, t1);
+
+    float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+    float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxDistance));
+    distance = enter;
+    return enter <= exit;
+}
+
+Frustum Frustum::fromMatrix(const glm::mat4& m) {
+    // Gribb/Hartmann plane extraction from the rows of the clip matrix
+    glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+    glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+    glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+    glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+    Frustum frustum;
+    frustum.planes[0] = row3 + row0;
+    frustum.planes[1] = row3 - row0;
+    frustum.planes[2] = row3 + row1;
+    frustum.planes[3] = row3 - row1;
+    frustum.planes[4] = row3 + row2;
+    frustum.planes[5] = row3 - row2;
+
+    for (glm::vec4& plane : frustum.planes) {
+        float length = glm::length(glm::vec3(plane));
+        if (length > 0.0f) plane /= length;
+    }
+    return frustum;
+}
+
+void AABBList::clear() {
+    minX.clear(); minY.clear(); minZ.clear();
+    maxX.clear(); maxY.clear(); maxZ.clear();
+}
+
+void AABBList::reserve(size_t count) {
+    minX.reserve(count); minY.reserve(count); minZ.reserve(count);
+    maxX.reserve(count); maxY.reserve(count); maxZ.reserve(count);
+}
+
+void AABBList::push(const AABB& box) {
+    minX.push_back(box.min.x); minY.push_back(box.min.y); minZ.push_back(box.min.z);
+    maxX.push_back(box.max.x); maxY.push_back(box.max.y); maxZ.push_back(box.max.z);
+}
+
+void AABBList::resize(size_t count) {
+    minX.resize(count); minY.resize(count); minZ.resize(count);
+    maxX.resize(count); maxY.resize(count); maxZ.resize(count);
+}
+
+void AABBList::set(size_t index, const AABB& box) {
+    minX[index] = box.min.x; minY[index] = box.min.y; minZ[index] = box.min.z;
+    maxX[index] = box.max.x; maxY[index] = box.max.y; maxZ[index] = box.max.z;
+}
+
+size_t cullAABBs(const Frustum& frustum, const AABBList& boxes, uint8_t* visible) {
+    const size_t count = boxes.size();
+
+    // For each plane only the box corner furthest along the normal matters, and
+    // that choice is the same for every box, so it is made once per plane here.
+    const float* cornerX[6];
+    const float* cornerY[6];
+    const float* cornerZ[6];
+    for (int p = 0; p < 6; p++) {
+        const glm::vec4& plane = frustum.planes[p];
+        cornerX[p] = plane.x >= 0.0f ? boxes.maxX.data() : boxes.minX.data();
+        cornerY[p] = plane.y >= 0.0f ? boxes.maxY.data() : boxes.minY.data();
+        cornerZ[p] = plane.z >= 0.0f ? boxes.maxZ.data() : boxes.minZ.data();
+    }
+
+    size_t visibleCount = 0;
+    size_t i = 0;
+
+#if defined(CULLING_AVX)
+    for (; i + 8 <= count; i += 8) {
+        __m256 outside = _mm256_setzero_ps();
+        for (int p = 0; p < 6; p++) {
+            const glm::vec4& plane = frustum.planes[p];
+            __m256 dist = _mm256_set1_ps(plane.w);
+            dist = _mm256_add_ps(dist, _mm256_mul_ps(_mm256_set1_ps(plane.x), _mm256_loadu_ps(cornerX[p] + i)));
+            dist = _mm256_add_ps(dist, _mm256_mul_ps(_mm256_set1_ps(plane.y), _mm256_loadu_ps(cornerY[p] + i)));
+            dist = _mm256_add_ps(dist, _mm256_mul_ps(_mm256_set1_ps(plane.z), _mm256_loadu_ps(cornerZ[p] + i)));
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(dist, _mm256_setzero_ps(), _CMP_LT_OQ));
+        }
+        int mask = _mm256_movemask_ps(outside);
+        for (int lane = 0; lane < 8; lane++) {
+            uint8_t in = (mask & (1 << lane)) ? 0 : 1;
+            visible[i + lane] = in;
+            visibleCount += in;
+        }
+    }
+#elif defined(CULLING_SSE)
+    for (; i + 4 <= count; i += 4) {
+        __m128 outside = _mm_setzero_ps();
+        for (int p = 0; p < 6; p++) {
+            const glm::vec4& plane = frustum.planes[p];
+            __m128 dist = _mm_set1_ps(plane.w);
+            dist = _mm_add_ps(dist, _mm_mul_ps(_mm_set1_ps(plane.x), _mm_loadu_ps(cornerX[p] + i)));
+            dist = _mm_add_ps(dist, _mm_mul_ps(_mm_set1_ps(plane.y), _mm_loadu_ps(cornerY[p] + i)));
+            dist = _mm_add_ps(dist, _mm_mul_ps(_mm_set1_ps(plane.z), _mm_loadu_ps(cornerZ[p] + i)));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(dist, _mm_setzero_ps()));
+        }
+        int mask = _mm_movemask_ps(outside);
+        for (int lane = 0; lane < 4; lane++) {
+            uint8_t in = (mask & (1 << lane)) ? 0 : 1;
+            visible[i + lane] = in;
+            visibleCount += in;
+        }
+    }
+#endif
+
+    // Scalar tail (and the whole list on targets without SSE)
+    for (; i < count; i++) {
+        bool in = true;
+        for (int p = 0; p < 6 && in; p++) {
+            const glm::vec4& plane = frustum.planes[p];
+            float dist = plane.x * cornerX[p][i] + plane.y * cornerY[p][i] + plane.z * cornerZ[p][i] + plane.w;
+            in = dist >= 0.0f;
+        }
+        visible[i] = in ? 1 : 0;
+        visibleCount += in ? 1 : 0;
+    }
+
+    return visibleCount;
+}
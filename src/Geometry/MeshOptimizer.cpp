@@ -0,0 +1,254 @@
+#include "../../include/Geometry/MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+uint32_t floatBits(float value) {
+    if (value == 0.0f) value = 0.0f;  // fold -0.0 into +0.0
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+uint64_t hashVertex(const float* vertex, size_t strideFloats) {
+    // FNV-1a over the float bit patterns
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < strideFloats; i++) {
+        hash ^= floatBits(vertex[i]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+bool sameVertex(const float* a, const float* b, size_t strideFloats) {
+    for (size_t i = 0; i < strideFloats; i++) {
+        if (floatBits(a[i]) != floatBits(b[i])) return false;
+    }
+    return true;
+}
+
+// Forsyth scoring constants
+constexpr size_t kCacheSize = 32;
+constexpr float kCacheDecayPower = 1.5f;
+constexpr float kLastTriScore = 0.75f;
+constexpr float kValenceBoostScale = 2.0f;
+constexpr float kValenceBoostPower = 0.5f;
+
+constexpr size_t kValenceTableSize = 32;
+
+// pow() is too slow to call per rescored vertex, so both score terms are tabulated
+struct ScoreTables {
+    float cache[kCacheSize];
+    float valence[kValenceTableSize];
+
+    ScoreTables() {
+        for (size_t i = 0; i < kCacheSize; i++) {
+            if (i < 3) {
+                // The last triangle's vertices get a fixed score so it isn't simply repeated
+                cache[i] = kLastTriScore;
+            } else {
+                const float scaler = 1.0f / (kCacheSize - 3);
+                cache[i] = std::pow(1.0f - (i - 3) * scaler, kCacheDecayPower);
+            }
+        }
+        for (size_t i = 0; i < kValenceTableSize; i++) {
+            valence[i] = i == 0 ? 0.0f : kValenceBoostScale * std::pow(static_cast<float>(i), -kValenceBoostPower);
+        }
+    }
+};
+
+float vertexScore(const ScoreTables& tables, int cachePosition, uint32_t remainingTriangles) {
+    if (remainingTriangles == 0) return -1.0f;
+
+    float score = cachePosition >= 0 ? tables.cache[cachePosition] : 0.0f;
+
+    // Favour vertices with few triangles left so they can drop out of the working set
+    if (remainingTriangles < kValenceTableSize) {
+        score += tables.valence[remainingTriangles];
+    } else {
+        score += kValenceBoostScale * std::pow(static_cast<float>(remainingTriangles), -kValenceBoostPower);
+    }
+    return score;
+}
+
+} // namespace
+
+IndexedMeshData weldVertices(const float* corners, size_t cornerCount, size_t strideFloats) {
+    IndexedMeshData result;
+    result.strideFloats = strideFloats;
+    result.indices.resize(cornerCount);
+    if (cornerCount == 0 || strideFloats == 0) return result;
+
+    // Open addressing table of output vertex indices, kept at most half full
+    size_t tableSize = 1;
+    while (tableSize < cornerCount * 2) tableSize <<= 1;
+    const uint32_t empty = UINT32_MAX;
+    std::vector<uint32_t> table(tableSize, empty);
+
+    result.vertices.reserve(cornerCount * strideFloats);
+    for (size_t c = 0; c < cornerCount; c++) {
+        const float* vertex = corners + c * strideFloats;
+        size_t slot = static_cast<size_t>(hashVertex(vertex, strideFloats)) & (tableSize - 1);
+
+        while (table[slot] != empty &&
+               !sameVertex(result.vertices.data() + size_t(table[slot]) * strideFloats, vertex, strideFloats)) {
+            slot = (slot + 1) & (tableSize - 1);
+        }
+
+        if (table[slot] == empty) {
+            table[slot] = static_cast<uint32_t>(result.vertices.size() / strideFloats);
+            result.vertices.insert(result.vertices.end(), vertex, vertex + strideFloats);
+        }
+        result.indices[c] = table[slot];
+    }
+
+    result.vertices.shrink_to_fit();
+    return result;
+}
+
+void optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount) {
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0 || vertexCount == 0) return;
+
+    // Vertex -> triangle adjacency in CSR form
+    std::vector<uint32_t> remaining(vertexCount, 0);
+    for (uint32_t index : indices) remaining[index]++;
+
+    std::vector<uint32_t> adjacencyOffset(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; v++) adjacencyOffset[v + 1] = adjacencyOffset[v] + remaining[v];
+
+    std::vector<uint32_t> adjacency(indices.size());
+    std::vector<uint32_t> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+    for (size_t t = 0; t < triangleCount; t++) {
+        for (size_t k = 0; k < 3; k++) adjacency[fill[indices[t * 3 + k]]++] = static_cast<uint32_t>(t);
+    }
+
+    static const ScoreTables tables;
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScores(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++) vertexScores[v] = vertexScore(tables, -1, remaining[v]);
+
+    std::vector<float> triangleScores(triangleCount);
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    for (size_t t = 0; t < triangleCount; t++) {
+        triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+    }
+
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+
+    // Cache holds up to kCacheSize entries plus the three being pushed
+    uint32_t cache[kCacheSize + 3];
+    size_t cacheCount = 0;
+
+    size_t scanCursor = 0;
+    int bestTriangle = -1;
+    float bestScore = -1.0f;
+
+    for (size_t emittedCount = 0; emittedCount < triangleCount; emittedCount++) {
+        if (bestTriangle < 0) {
+            // Nothing adjacent to the cache is left; take the next unemitted triangle
+            while (emitted[scanCursor]) scanCursor++;
+            bestTriangle = static_cast<int>(scanCursor);
+        }
+
+        const uint32_t* tri = &indices[size_t(bestTriangle) * 3];
+        output.insert(output.end(), tri, tri + 3);
+        emitted[bestTriangle] = 1;
+
+        // Push the triangle's vertices to the front of the LRU cache
+        uint32_t newCache[kCacheSize + 3];
+        size_t newCount = 0;
+        for (size_t k = 0; k < 3; k++) {
+            // Degenerate triangles repeat a vertex; it only enters the cache once
+            if (std::find(newCache, newCache + newCount, tri[k]) == newCache + newCount) newCache[newCount++] = tri[k];
+            remaining[tri[k]]--;
+
+            // Drop the emitted triangle from the vertex's adjacency list
+            uint32_t* begin = &adjacency[adjacencyOffset[tri[k]]];
+            uint32_t* end = begin + remaining[tri[k]] + 1;
+            *std::find(begin, end, static_cast<uint32_t>(bestTriangle)) = *(end - 1);
+        }
+        for (size_t i = 0; i < cacheCount; i++) {
+            uint32_t v = cache[i];
+            if (v != tri[0] && v != tri[1] && v != tri[2]) newCache[newCount++] = v;
+        }
+
+        // Rescore everything that was or is in the cache
+        for (size_t i = 0; i < newCount; i++) {
+            uint32_t v = newCache[i];
+            cachePosition[v] = i < kCacheSize ? static_cast<int>(i) : -1;
+            float score = vertexScore(tables, cachePosition[v], remaining[v]);
+            float delta = score - vertexScores[v];
+            vertexScores[v] = score;
+
+            for (uint32_t a = adjacencyOffset[v]; a < adjacencyOffset[v] + remaining[v]; a++) {
+                triangleScores[adjacency[a]] += delta;
+            }
+        }
+
+        cacheCount = std::min(newCount, kCacheSize);
+        std::copy(newCache, newCache + cacheCount, cache);
+
+        // The next triangle is the best one touching the cache
+        bestTriangle = -1;
+        bestScore = -1.0f;
+        for (size_t i = 0; i < cacheCount; i++) {
+            uint32_t v = cache[i];
+            for (uint32_t a = adjacencyOffset[v]; a < adjacencyOffset[v] + remaining[v]; a++) {
+                uint32_t t = adjacency[a];
+                if (triangleScores[t] > bestScore) {
+                    bestScore = triangleScores[t];
+                    bestTriangle = static_cast<int>(t);
+                }
+            }
+        }
+    }
+
+    indices.swap(output);
+}
+
+void optimizeVertexFetch(IndexedMeshData& mesh) {
+    const size_t vertexCount = mesh.getVertexCount();
+    const size_t stride = mesh.strideFloats;
+    std::vector<uint32_t> remap(vertexCount, UINT32_MAX);
+    std::vector<float> reordered;
+    reordered.reserve(mesh.vertices.size());
+
+    uint32_t next = 0;
+    for (uint32_t& index : mesh.indices) {
+        if (remap[index] == UINT32_MAX) {
+            remap[index] = next++;
+            const float* vertex = mesh.vertices.data() + size_t(index) * stride;
+            reordered.insert(reordered.end(), vertex, vertex + stride);
+        }
+        index = remap[index];
+    }
+
+    mesh.vertices.swap(reordered);
+}
+
+float computeACMR(const std::vector<uint32_t>& indices, size_t vertexCount, size_t cacheSize) {
+    if (indices.size() < 3) return 0.0f;
+
+    // FIFO cache simulation using the time each vertex last entered the cache
+    std::vector<size_t> entryTime(vertexCount, 0);
+    size_t clock = 0;
+    size_t misses = 0;
+    for (uint32_t index : indices) {
+        if (entryTime[index] == 0 || clock - entryTime[index] >= cacheSize) {
+            entryTime[index] = ++clock;
+            misses++;
+        }
+    }
+    return static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+}
+
+IndexedMeshData buildIndexedMesh(const float* corners, size_t cornerCount, size_t strideFloats) {
+    IndexedMeshData mesh = weldVertices(corners, cornerCount, strideFloats);
+    optimizeVertexCache(mesh.indices, mesh.getVertexCount());
+    optimizeVertexFetch(mesh);
+    return mesh;
+}
@@ -0,0 +1,307 @@
+#include "../../include/Geometry/MeshSimplifier.h"
+#include "../ThirdParty/glm/glm.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Symmetric 4x4 error quadric
+struct Quadric {
+    double xx = 0, xy = 0, xz = 0, xw = 0;
+    double yy = 0, yz = 0, yw = 0;
+    double zz = 0, zw = 0;
+    double ww = 0;
+
+    static Quadric fromPlane(const glm::dvec3& n, double d, double weight) {
+        Quadric q;
+        q.xx = weight * n.x * n.x; q.xy = weight * n.x * n.y; q.xz = weight * n.x * n.z; q.xw = weight * n.x * d;
+        q.yy = weight * n.y * n.y; q.yz = weight * n.y * n.z; q.yw = weight * n.y * d;
+        q.zz = weight * n.z * n.z; q.zw = weight * n.z * d;
+        q.ww = weight * d * d;
+        return q;
+    }
+
+    Quadric& operator+=(const Quadric& o) {
+        xx += o.xx; xy += o.xy; xz += o.xz; xw += o.xw;
+        yy += o.yy; yz += o.yz; yw += o.yw;
+        zz += o.zz; zw += o.zw;
+        ww += o.ww;
+        return *this;
+    }
+
+    double evaluate(const glm::vec3& p) const {
+        double x = p.x, y = p.y, z = p.z;
+        double e = xx * x * x + 2 * xy * x * y + 2 * xz * x * z + 2 * xw * x
+                 + yy * y * y + 2 * yz * y * z + 2 * yw * y
+                 + zz * z * z + 2 * zw * z
+                 + ww;
+        return std::max(e, 0.0);
+    }
+};
+
+// Open borders are pinned by planes through the edge perpendicular to its face
+constexpr double kBorderWeight = 10.0;
+
+// A collapse is rejected if any surviving triangle's normal turns by more than ~78 degrees
+constexpr float kMinNormalDot = 0.2f;
+
+struct Collapse {
+    uint32_t source;
+    uint32_t target;
+    double cost;
+};
+
+} // namespace
+
+std::vector<uint32_t> simplifyMesh(const std::vector<float>& vertices, size_t strideFloats,
+                                   const std::vector<uint32_t>& indices, size_t targetIndexCount,
+                                   float* resultError) {
+    if (resultError) *resultError = 0.0f;
+    const size_t vertexCount = strideFloats ? vertices.size() / strideFloats : 0;
+    if (indices.size() <= targetIndexCount || vertexCount == 0) return indices;
+
+    // Topology works on unique positions; a position owns one vertex per attribute set
+    std::vector<float> positionSoup(vertexCount * 3);
+    for (size_t v = 0; v < vertexCount; v++) {
+        std::copy(&vertices[v * strideFloats], &vertices[v * strideFloats] + 3, &positionSoup[v * 3]);
+    }
+    IndexedMeshData welded = weldVertices(positionSoup.data(), vertexCount, 3);
+    const std::vector<uint32_t>& positionOf = welded.indices;
+    const size_t positionCount = welded.getVertexCount();
+    auto position = [&](uint32_t p) {
+        return glm::vec3(welded.vertices[p * 3], welded.vertices[p * 3 + 1], welded.vertices[p * 3 + 2]);
+    };
+
+    std::vector<uint32_t> wedgeOffset(positionCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; v++) wedgeOffset[positionOf[v] + 1]++;
+    for (size_t p = 0; p < positionCount; p++) wedgeOffset[p + 1] += wedgeOffset[p];
+    std::vector<uint32_t> wedges(vertexCount);
+    {
+        std::vector<uint32_t> fill(wedgeOffset.begin(), wedgeOffset.end() - 1);
+        for (size_t v = 0; v < vertexCount; v++) wedges[fill[positionOf[v]]++] = static_cast<uint32_t>(v);
+    }
+
+    glm::vec3 minPos = position(0), maxPos = position(0);
+    for (size_t p = 1; p < positionCount; p++) {
+        minPos = glm::min(minPos, position(static_cast<uint32_t>(p)));
+        maxPos = glm::max(maxPos, position(static_cast<uint32_t>(p)));
+    }
+    float extent = std::max(glm::length(maxPos - minPos), 1e-6f);
+
+    std::vector<uint32_t> triangles;
+    triangles.reserve(indices.size());
+    for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+        uint32_t p0 = positionOf[indices[t]], p1 = positionOf[indices[t + 1]], p2 = positionOf[indices[t + 2]];
+        if (p0 == p1 || p1 == p2 || p0 == p2) continue;
+        triangles.insert(triangles.end(), &indices[t], &indices[t] + 3);
+    }
+
+    // Area-weighted face quadrics
+    std::vector<Quadric> quadrics(positionCount);
+    for (size_t t = 0; t < triangles.size(); t += 3) {
+        glm::dvec3 p0 = position(positionOf[triangles[t]]);
+        glm::dvec3 p1 = position(positionOf[triangles[t + 1]]);
+        glm::dvec3 p2 = position(positionOf[triangles[t + 2]]);
+        glm::dvec3 n = glm::cross(p1 - p0, p2 - p0);
+        double area = glm::length(n);
+        if (area <= 0.0) continue;
+        n /= area;
+
+        Quadric q = Quadric::fromPlane(n, -glm::dot(n, p0), area * 0.5);
+        for (size_t k = 0; k < 3; k++) quadrics[positionOf[triangles[t + k]]] += q;
+    }
+
+    // Border edges are the ones used by a single triangle
+    {
+        std::vector<std::pair<uint64_t, uint32_t>> edges;  // (sorted edge key, triangle)
+        edges.reserve(triangles.size());
+        for (size_t t = 0; t < triangles.size(); t += 3) {
+            for (size_t k = 0; k < 3; k++) {
+                uint64_t a = positionOf[triangles[t + k]], b = positionOf[triangles[t + (k + 1) % 3]];
+                edges.push_back({ (std::min(a, b) << 32) | std::max(a, b), static_cast<uint32_t>(t) });
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+
+        for (size_t i = 0; i < edges.size();) {
+            size_t j = i + 1;
+            while (j < edges.size() && edges[j].first == edges[i].first) j++;
+            if (j - i == 1) {
+                uint32_t a = static_cast<uint32_t>(edges[i].first >> 32);
+                uint32_t b = static_cast<uint32_t>(edges[i].first & 0xFFFFFFFFu);
+                uint32_t t = edges[i].second;
+                glm::dvec3 p0 = position(positionOf[triangles[t]]);
+                glm::dvec3 faceNormal = glm::cross(glm::dvec3(position(positionOf[triangles[t + 1]])) - p0,
+                                                   glm::dvec3(position(positionOf[triangles[t + 2]])) - p0);
+                glm::dvec3 pa = position(a), pb = position(b);
+                glm::dvec3 edge = pb - pa;
+                glm::dvec3 n = glm::cross(edge, faceNormal);
+                double length = glm::length(n);
+                if (length > 0.0) {
+                    n /= length;
+                    Quadric q = Quadric::fromPlane(n, -glm::dot(n, pa), kBorderWeight * glm::dot(edge, edge));
+                    quadrics[a] += q;
+                    quadrics[b] += q;
+                }
+            }
+            i = j;
+        }
+    }
+
+    std::vector<uint32_t> adjacencyOffset(positionCount + 1);
+    std::vector<uint32_t> adjacency;
+    std::vector<uint64_t> edgeKeys;
+    std::vector<Collapse> collapses;
+    std::vector<uint8_t> locked(positionCount);
+    std::vector<uint32_t> positionRemap(positionCount);
+    std::vector<uint32_t> wedgeRemap(vertexCount);
+    double maxCost = 0.0;
+
+    auto flips = [&](uint32_t source, uint32_t target) {
+        glm::vec3 targetPos = position(target);
+        for (uint32_t a = adjacencyOffset[source]; a < adjacencyOffset[source + 1]; a++) {
+            const uint32_t* tri = &triangles[adjacency[a]];
+            uint32_t p[3] = { positionOf[tri[0]], positionOf[tri[1]], positionOf[tri[2]] };
+            if (p[0] == target || p[1] == target || p[2] == target) continue;  // collapses away
+
+            glm::vec3 before[3] = { position(p[0]), position(p[1]), position(p[2]) };
+            glm::vec3 after[3] = { before[0], before[1], before[2] };
+            for (size_t k = 0; k < 3; k++) {
+                if (p[k] == source) after[k] = targetPos;
+            }
+
+            glm::vec3 n0 = glm::cross(before[1] - before[0], before[2] - before[0]);
+            glm::vec3 n1 = glm::cross(after[1] - after[0], after[2] - after[0]);
+            float len0 = glm::length(n0), len1 = glm::length(n1);
+            if (len1 <= 0.0f || glm::dot(n0, n1) < kMinNormalDot * len0 * len1) return true;
+        }
+        return false;
+    };
+
+    while (triangles.size() > targetIndexCount) {
+        // Position -> triangle adjacency for this pass
+        std::fill(adjacencyOffset.begin(), adjacencyOffset.end(), 0);
+        for (uint32_t corner : triangles) adjacencyOffset[positionOf[corner] + 1]++;
+        for (size_t p = 0; p < positionCount; p++) adjacencyOffset[p + 1] += adjacencyOffset[p];
+        adjacency.resize(triangles.size());
+        {
+            std::vector<uint32_t> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+            for (size_t c = 0; c < triangles.size(); c++) {
+                adjacency[fill[positionOf[triangles[c]]]++] = static_cast<uint32_t>(c - c % 3);
+            }
+        }
+
+        edgeKeys.clear();
+        for (size_t t = 0; t < triangles.size(); t += 3) {
+            for (size_t k = 0; k < 3; k++) {
+                uint64_t a = positionOf[triangles[t + k]], b = positionOf[triangles[t + (k + 1) % 3]];
+                edgeKeys.push_back((std::min(a, b) << 32) | std::max(a, b));
+            }
+        }
+        std::sort(edgeKeys.begin(), edgeKeys.end());
+        edgeKeys.erase(std::unique(edgeKeys.begin(), edgeKeys.end()), edgeKeys.end());
+
+        // Cheaper direction of every edge, cheapest edges first
+        collapses.clear();
+        for (uint64_t key : edgeKeys) {
+            uint32_t a = static_cast<uint32_t>(key >> 32);
+            uint32_t b = static_cast<uint32_t>(key & 0xFFFFFFFFu);
+            Quadric q = quadrics[a];
+            q += quadrics[b];
+            double costToB = q.evaluate(position(b));
+            double costToA = q.evaluate(position(a));
+            if (costToB <= costToA) collapses.push_back({ a, b, costToB });
+            else collapses.push_back({ b, a, costToA });
+        }
+        std::sort(collapses.begin(), collapses.end(),
+            [](const Collapse& x, const Collapse& y) { return x.cost < y.cost; });
+
+        std::fill(locked.begin(), locked.end(), 0);
+        for (size_t p = 0; p < positionCount; p++) positionRemap[p] = static_cast<uint32_t>(p);
+
+        // Collapses within a pass touch disjoint one-rings, so the adjacency above stays valid
+        size_t remaining = triangles.size() / 3;
+        size_t collapsed = 0;
+        for (const Collapse& collapse : collapses) {
+            if (remaining * 3 <= targetIndexCount) break;
+            if (locked[collapse.source] || locked[collapse.target]) continue;
+            if (flips(collapse.source, collapse.target)) continue;
+
+            size_t removed = 0;
+            for (uint32_t a = adjacencyOffset[collapse.source]; a < adjacencyOffset[collapse.source + 1]; a++) {
+                const uint32_t* tri = &triangles[adjacency[a]];
+                for (size_t k = 0; k < 3; k++) {
+                    locked[positionOf[tri[k]]] = 1;
+                    if (positionOf[tri[k]] == collapse.target) removed++;
+                }
+            }
+            locked[collapse.target] = 1;
+
+            positionRemap[collapse.source] = collapse.target;
+            quadrics[collapse.target] += quadrics[collapse.source];
+            maxCost = std::max(maxCost, collapse.cost);
+            remaining -= std::min(removed, remaining);
+            collapsed++;
+
+            // Each vertex at the source moves to the target vertex with the closest attributes
+            for (uint32_t w = wedgeOffset[collapse.source]; w < wedgeOffset[collapse.source + 1]; w++) {
+                const float* from = &vertices[size_t(wedges[w]) * strideFloats];
+                uint32_t best = wedges[wedgeOffset[collapse.target]];
+                float bestDistance = -1.0f;
+                for (uint32_t u = wedgeOffset[collapse.target]; u < wedgeOffset[collapse.target + 1]; u++) {
+                    const float* to = &vertices[size_t(wedges[u]) * strideFloats];
+                    float distance = 0.0f;
+                    for (size_t f = 3; f < strideFloats; f++) distance += (from[f] - to[f]) * (from[f] - to[f]);
+                    if (bestDistance < 0.0f || distance < bestDistance) {
+                        bestDistance = distance;
+                        best = wedges[u];
+                    }
+                }
+                wedgeRemap[wedges[w]] = best;
+            }
+        }
+
+        if (collapsed == 0) break;
+
+        // Rewrite corners and drop the triangles that became degenerate
+        size_t write = 0;
+        for (size_t t = 0; t < triangles.size(); t += 3) {
+            uint32_t tri[3];
+            for (size_t k = 0; k < 3; k++) {
+                uint32_t corner = triangles[t + k];
+                tri[k] = positionRemap[positionOf[corner]] != positionOf[corner] ? wedgeRemap[corner] : corner;
+            }
+            uint32_t p0 = positionOf[tri[0]], p1 = positionOf[tri[1]], p2 = positionOf[tri[2]];
+            if (p0 == p1 || p1 == p2 || p0 == p2) continue;
+            triangles[write++] = tri[0];
+            triangles[write++] = tri[1];
+            triangles[write++] = tri[2];
+        }
+        triangles.resize(write);
+    }
+
+    if (resultError) *resultError = static_cast<float>(std::sqrt(maxCost)) / extent;
+    return triangles;
+}
+
+std::vector<MeshLodLevel> buildLodChain(const IndexedMeshData& mesh, const std::vector<float>& triangleRatios) {
+    std::vector<MeshLodLevel> levels(1);
+    levels[0].indices = mesh.indices;
+
+    for (float ratio : triangleRatios) {
+        size_t target = static_cast<size_t>(mesh.indices.size() / 3 * ratio) * 3;
+        const std::vector<uint32_t>& parent = levels.back().indices;
+
+        MeshLodLevel level;
+        level.indices = simplifyMesh(mesh.vertices, mesh.strideFloats, parent, target, &level.error);
+        level.error = std::max(level.error, levels.back().error);
+
+        // Not worth a level if it barely shrank; later ratios would stall the same way
+        if (level.indices.empty() || level.indices.size() > parent.size() * 3 / 4) break;
+
+        optimizeVertexCache(level.indices, mesh.getVertexCount());
+        levels.push_back(std::move(level));
+    }
+
+    return levels;
+}
@@ -0,0 +1,126 @@
+#include "../../include/Geometry/VertexFormat.h"
+#include "../ThirdParty/glm/gtc/packing.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+constexpr size_t kSourceStride = 8;
+
+// Largest position error we accept from half floats, relative to the mesh diagonal
+constexpr float kHalfPositionTolerance = 1.0f / 1024.0f;
+// Largest UV step we accept from half floats: one texel of a 1024 texture
+constexpr float kHalfUVTolerance = 1.0f / 1024.0f;
+
+// Distance between neighbouring half floats around value (10 mantissa bits)
+float halfSpacing(float value) {
+    int exponent = 0;
+    std::frexp(value, &exponent);
+    return std::ldexp(1.0f, exponent - 11);
+}
+
+size_t attributeSize(const VertexAttribute& attribute) {
+    size_t componentSize = attribute.type == VertexAttributeType::Float ? 4 : 2;
+    // Keep every attribute 4-byte aligned
+    return (attribute.components * componentSize + 3) & ~size_t(3);
+}
+
+void writeComponents(uint8_t* dst, const float* values, const VertexAttribute& attribute) {
+    for (int c = 0; c < attribute.components; c++) {
+        switch (attribute.type) {
+            case VertexAttributeType::Float:
+                std::memcpy(dst + c * 4, &values[c], 4);
+                break;
+            case VertexAttributeType::HalfFloat: {
+                uint16_t half = glm::packHalf1x16(values[c]);
+                std::memcpy(dst + c * 2, &half, 2);
+                break;
+            }
+            case VertexAttributeType::SNorm16: {
+                uint16_t snorm = glm::packSnorm1x16(values[c]);
+                std::memcpy(dst + c * 2, &snorm, 2);
+                break;
+            }
+            case VertexAttributeType::UNorm16: {
+                uint16_t unorm = glm::packUnorm1x16(values[c]);
+                std::memcpy(dst + c * 2, &unorm, 2);
+                break;
+            }
+        }
+    }
+}
+
+} // namespace
+
+glm::vec2 octEncode(const glm::vec3& normal) {
+    float l1 = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    if (l1 == 0.0f || !std::isfinite(l1)) return glm::vec2(0.0f);  // decodes to +Z
+
+    glm::vec2 p = glm::vec2(normal.x, normal.y) / l1;
+    if (normal.z < 0.0f) {
+        // Fold the lower hemisphere over the diagonals
+        p = glm::vec2((1.0f - std::abs(p.y)) * (p.x >= 0.0f ? 1.0f : -1.0f),
+                      (1.0f - std::abs(p.x)) * (p.y >= 0.0f ? 1.0f : -1.0f));
+    }
+    return p;
+}
+
+glm::vec3 octDecode(const glm::vec2& e) {
+    glm::vec3 n(e.x, e.y, 1.0f - std::abs(e.x) - std::abs(e.y));
+    float t = std::max(-n.z, 0.0f);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+    return glm::normalize(n);
+}
+
+PackedVertexData packVertices(const float* vertices, size_t vertexCount) {
+    glm::vec3 minPos(0.0f), maxPos(0.0f);
+    glm::vec2 minUV(0.0f), maxUV(0.0f);
+    for (size_t i = 0; i < vertexCount; i++) {
+        const float* v = vertices + i * kSourceStride;
+        glm::vec3 pos(v[0], v[1], v[2]);
+        glm::vec2 uv(v[6], v[7]);
+        minPos = i == 0 ? pos : glm::min(minPos, pos);
+        maxPos = i == 0 ? pos : glm::max(maxPos, pos);
+        minUV = i == 0 ? uv : glm::min(minUV, uv);
+        maxUV = i == 0 ? uv : glm::max(maxUV, uv);
+    }
+
+    // Half spacing at the largest coordinate must be small next to the mesh itself
+    glm::vec3 maxAbs = glm::max(glm::abs(minPos), glm::abs(maxPos));
+    float maxCoord = std::max(maxAbs.x, std::max(maxAbs.y, maxAbs.z));
+    float diagonal = glm::length(maxPos - minPos);
+    bool halfPositions = false;
+    if (maxCoord < 65504.0f && diagonal > 0.0f) {
+        halfPositions = halfSpacing(maxCoord) <= diagonal * kHalfPositionTolerance;
+    }
+
+    // Tiling UVs outside [0, 1] only stay half while the step at the largest one is
+    // finer than a texel, or the texture visibly snaps
+    bool unormUVs = minUV.x >= 0.0f && minUV.y >= 0.0f && maxUV.x <= 1.0f && maxUV.y <= 1.0f;
+    glm::vec2 maxAbsUV = glm::max(glm::abs(minUV), glm::abs(maxUV));
+    bool halfUVs = !unormUVs && halfSpacing(std::max(maxAbsUV.x, maxAbsUV.y)) <= kHalfUVTolerance;
+    VertexAttributeType uvType = unormUVs ? VertexAttributeType::UNorm16
+                                          : (halfUVs ? VertexAttributeType::HalfFloat : VertexAttributeType::Float);
+
+    PackedVertexData packed;
+    VertexLayout& layout = packed.layout;
+    layout.position = { 0, 3, halfPositions ? VertexAttributeType::HalfFloat : VertexAttributeType::Float, 0 };
+    layout.normal = { 1, 2, VertexAttributeType::SNorm16, attributeSize(layout.position) };
+    layout.texCoord = { 2, 2, uvType, layout.normal.offset + attributeSize(layout.normal) };
+    layout.stride = layout.texCoord.offset + attributeSize(layout.texCoord);
+
+    packed.bytes.assign(vertexCount * layout.stride, 0);
+    for (size_t i = 0; i < vertexCount; i++) {
+        const float* v = vertices + i * kSourceStride;
+        uint8_t* dst = packed.bytes.data() + i * layout.stride;
+
+        glm::vec2 oct = octEncode(glm::vec3(v[3], v[4], v[5]));
+        writeComponents(dst + layout.position.offset, v, layout.position);
+        writeComponents(dst + layout.normal.offset, &oct.x, layout.normal);
+        writeComponents(dst + layout.texCoord.offset, v + 6, layout.texCoord);
+    }
+
+    return packed;
+}
@@ -0,0 +1,184 @@
+#include "../../include/Lighting/CascadedShadowMap.h"
+#include "../../include/Rendering/GLStateCache.h"
+#include "../../include/Shaders/UniformBuffer.h"
+#include "../ThirdParty/glm/gtc/matrix_transform.hpp"
+#include <glad/glad.h>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Blend between logarithmic (1) and uniform (0) split spacing
+const float SplitLambda = 0.75f;
+// Extra radius each cascade gets so small camera moves don't re-centre it
+const float GuardBand = 0.2f;
+// How far behind a cascade (toward the sun) casters are still rendered
+const float CasterExtension = 100.0f;
+
+} // namespace
+
+CascadedShadowMap::CascadedShadowMap(int mapResolution) : resolution(mapResolution) {
+    shadowTexture = createDepthArray(true);
+    staticTexture = createDepthArray(false);
+
+    // Depth-only targets; the layer is attached per pass
+    glGenFramebuffers(1, &shadowFramebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, shadowFramebuffer);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadowTexture, 0, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+
+    glGenFramebuffers(1, &staticFramebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, staticFramebuffer);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, staticTexture, 0, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+CascadedShadowMap::~CascadedShadowMap() {
+    glDeleteFramebuffers(1, &shadowFramebuffer);
+    glDeleteFramebuffers(1, &staticFramebuffer);
+    glDeleteTextures(1, &shadowTexture);
+    glDeleteTextures(1, &staticTexture);
+}
+
+unsigned int CascadedShadowMap::createDepthArray(bool sampled) {
+    unsigned int texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT24, resolution, resolution, CascadeCount, 0,
+                 GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+
+    if (sampled) {
+        // Hardware depth comparison with bilinear filtering gives 2x2 PCF per tap
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    } else {
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    }
+    // Outside the map counts as lit
+    const float border[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, border);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    return texture;
+}
+
+void CascadedShadowMap::update(const glm::mat4& view, const glm::mat4& projection, float nearPlane, float shadowDistance,
+                               const glm::vec3& newSunDirection) {
+    glm::vec3 sun = glm::normalize(newSunDirection);
+    bool sunChanged = glm::dot(sun, sunDirection) < 0.999999f;
+    if (sunChanged) sunDirection = sun;
+
+    glm::mat4 invView = glm::inverse(view);
+    glm::vec3 cameraPos(invView[3]);
+    glm::vec3 forward = -glm::normalize(glm::vec3(invView[2]));
+
+    // Squared half-diagonal of the frustum cross-section per unit of depth
+    float tanX = 1.0f / projection[0][0];
+    float tanY = 1.0f / projection[1][1];
+    float diagonal = tanX * tanX + tanY * tanY;
+
+    float splitNear = nearPlane;
+    for (int i = 0; i < CascadeCount; i++) {
+        float fraction = static_cast<float>(i + 1) / CascadeCount;
+        float logSplit = nearPlane * std::pow(shadowDistance / nearPlane, fraction);
+        float uniformSplit = nearPlane + (shadowDistance - nearPlane) * fraction;
+        float splitFar = SplitLambda * logSplit + (1.0f - SplitLambda) * uniformSplit;
+
+        // Smallest sphere around the slice: its centre lies on the view axis where the
+        // near and far corners are equally distant, or at the far plane for wide slices
+        float centerDepth = 0.5f * (splitFar + splitNear) * (1.0f + diagonal);
+        float farDiagonal = splitFar * splitFar * diagonal;
+        float sliceRadius;
+        if (centerDepth > splitFar) {
+            centerDepth = splitFar;
+            sliceRadius = std::sqrt(farDiagonal);
+        } else {
+            sliceRadius = std::sqrt((splitFar - centerDepth) * (splitFar - centerDepth) + farDiagonal);
+        }
+
+        cascades[i].splitDepth = splitFar;
+        fitCascade(cascades[i], cameraPos + forward * centerDepth, sliceRadius, sunChanged);
+        splitNear = splitFar;
+    }
+}
+
+void CascadedShadowMap::fitCascade(Cascade& cascade, const glm::vec3& sliceCenter, float sliceRadius, bool sunChanged) {
+    float padded = sliceRadius * (1.0f + GuardBand);
+    bool fits = cascade.radius >= sliceRadius && cascade.radius <= padded * 1.5f &&
+                glm::length(sliceCenter - cascade.center) + sliceRadius <= cascade.radius;
+    if (fits && !sunChanged) return;
+
+    if (!fits) {
+        cascade.center = sliceCenter;
+        cascade.radius = padded;
+    }
+
+    glm::vec3 up = std::abs(sunDirection.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+    glm::mat4 lightView = glm::lookAt(glm::vec3(0.0f), -sunDirection, up);
+
+    // Snap the centre to whole texels in light space, so re-centring never shifts the
+    // rasterisation grid by a fraction of a texel
+    float r = cascade.radius;
+    float texel = 2.0f * r / resolution;
+    glm::vec3 lc(lightView * glm::vec4(cascade.center, 1.0f));
+    lc.x = std::floor(lc.x / texel) * texel;
+    lc.y = std::floor(lc.y / texel) * texel;
+
+    // Light space looks down -z; casters between the cascade and the sun have larger z
+    float zNear = -(lc.z + r + CasterExtension);
+    float zFar = -(lc.z - r);
+    glm::mat4 lightProjection = glm::ortho(lc.x - r, lc.x + r, lc.y - r, lc.y + r, zNear, zFar);
+    cascade.viewProjection = lightProjection * lightView;
+    cascade.texelSize = texel;
+
+    AABB lightBox;
+    lightBox.min = glm::vec3(lc.x - r, lc.y - r, lc.z - r);
+    lightBox.max = glm::vec3(lc.x + r, lc.y + r, lc.z + r + CasterExtension);
+    cascade.casterBounds = transformAABB(lightBox, glm::inverse(lightView));
+    cascade.staticDirty = true;
+}
+
+void CascadedShadowMap::invalidateStatic() {
+    for (Cascade& cascade : cascades) cascade.staticDirty = true;
+}
+
+void CascadedShadowMap::beginStaticPass(GLStateCache& state, int cascade) {
+    state.bindFramebuffer(staticFramebuffer);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, staticTexture, 0, cascade);
+    glViewport(0, 0, resolution, resolution);
+    glClear(GL_DEPTH_BUFFER_BIT);
+}
+
+void CascadedShadowMap::endStaticPass(int cascade) {
+    cascades[cascade].staticDirty = false;
+}
+
+void CascadedShadowMap::beginCompositePass(GLStateCache& state, int cascade, bool hasDynamicCasters) {
+    state.bindFramebuffer(shadowFramebuffer);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadowTexture, 0, cascade);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, staticFramebuffer);
+    glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, staticTexture, 0, cascade);
+    glBlitFramebuffer(0, 0, resolution, resolution, 0, 0, resolution, resolution, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    // Read and draw bindings back in step, as the state cache assumes
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, shadowFramebuffer);
+
+    glViewport(0, 0, resolution, resolution);
+    cascades[cascade].hasDynamic = hasDynamicCasters;
+}
+
+void CascadedShadowMap::fillUniforms(ShadowUniforms& uniforms) const {
+    for (int i = 0; i < CascadeCount; i++) {
+        uniforms.cascadeViewProjection[i] = cascades[i].viewProjection;
+        uniforms.cascadeSplits[i] = cascades[i].splitDepth;
+        uniforms.cascadeTexelSizes[i] = cascades[i].texelSize;
+    }
+}
@@ -0,0 +1,228 @@
+#include "../../include/Lighting/LightClusters.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define CLUSTERS_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CLUSTERS_SSE 1
+#endif
+
+void LightSphereList::clear() {
+    x.clear();
+    y.clear();
+    depth.clear();
+    radius.clear();
+    index.clear();
+}
+
+void LightSphereList::push(float px, float py, float pdepth, float pradius, uint32_t lightIndex) {
+    x.push_back(px);
+    y.push_back(py);
+    depth.push_back(pdepth);
+    radius.push_back(pradius);
+    index.push_back(lightIndex);
+}
+
+namespace {
+
+// Calls emit(i) for every sphere of in that overlaps box, in list order
+template <typename Emit>
+void forEachOverlap(const LightSphereList& in, const AABB& box, Emit emit) {
+    const size_t count = in.size();
+    size_t i = 0;
+
+    // Squared distance from each sphere centre to the box, compared with the squared radius
+#if defined(CLUSTERS_AVX)
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 minX = _mm256_set1_ps(box.min.x), maxX = _mm256_set1_ps(box.max.x);
+    const __m256 minY = _mm256_set1_ps(box.min.y), maxY = _mm256_set1_ps(box.max.y);
+    const __m256 minZ = _mm256_set1_ps(box.min.z), maxZ = _mm256_set1_ps(box.max.z);
+    for (; i + 8 <= count; i += 8) {
+        __m256 px = _mm256_loadu_ps(in.x.data() + i);
+        __m256 py = _mm256_loadu_ps(in.y.data() + i);
+        __m256 pz = _mm256_loadu_ps(in.depth.data() + i);
+        __m256 r = _mm256_loadu_ps(in.radius.data() + i);
+        __m256 dx = _mm256_max_ps(_mm256_max_ps(_mm256_sub_ps(minX, px), _mm256_sub_ps(px, maxX)), zero);
+        __m256 dy = _mm256_max_ps(_mm256_max_ps(_mm256_sub_ps(minY, py), _mm256_sub_ps(py, maxY)), zero);
+        __m256 dz = _mm256_max_ps(_mm256_max_ps(_mm256_sub_ps(minZ, pz), _mm256_sub_ps(pz, maxZ)), zero);
+        __m256 dist = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_add_ps(_mm256_mul_ps(dy, dy), _mm256_mul_ps(dz, dz)));
+        int mask = _mm256_movemask_ps(_mm256_cmp_ps(dist, _mm256_mul_ps(r, r), _CMP_LE_OQ));
+        for (size_t lane = 0; mask; lane++, mask >>= 1) {
+            if (mask & 1) emit(i + lane);
+        }
+    }
+#elif defined(CLUSTERS_SSE)
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 minX = _mm_set1_ps(box.min.x), maxX = _mm_set1_ps(box.max.x);
+    const __m128 minY = _mm_set1_ps(box.min.y), maxY = _mm_set1_ps(box.max.y);
+    const __m128 minZ = _mm_set1_ps(box.min.z), maxZ = _mm_set1_ps(box.max.z);
+    for (; i + 4 <= count; i += 4) {
+        __m128 px = _mm_loadu_ps(in.x.data() + i);
+        __m128 py = _mm_loadu_ps(in.y.data() + i);
+        __m128 pz = _mm_loadu_ps(in.depth.data() + i);
+        __m128 r = _mm_loadu_ps(in.radius.data() + i);
+        __m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(minX, px), _mm_sub_ps(px, maxX)), zero);
+        __m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(minY, py), _mm_sub_ps(py, maxY)), zero);
+        __m128 dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(minZ, pz), _mm_sub_ps(pz, maxZ)), zero);
+        __m128 dist = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_add_ps(_mm_mul_ps(dy, dy), _mm_mul_ps(dz, dz)));
+        int mask = _mm_movemask_ps(_mm_cmple_ps(dist, _mm_mul_ps(r, r)));
+        for (size_t lane = 0; mask; lane++, mask >>= 1) {
+            if (mask & 1) emit(i + lane);
+        }
+    }
+#endif
+
+    // Scalar tail (and the whole list on targets without SSE)
+    for (; i < count; i++) {
+        float dx = std::max(std::max(box.min.x - in.x[i], in.x[i] - box.max.x), 0.0f);
+        float dy = std::max(std::max(box.min.y - in.y[i], in.y[i] - box.max.y), 0.0f);
+        float dz = std::max(std::max(box.min.z - in.depth[i], in.depth[i] - box.max.z), 0.0f);
+        if (dx * dx + dy * dy + dz * dz <= in.radius[i] * in.radius[i]) emit(i);
+    }
+}
+
+} // namespace
+
+void filterLightSpheres(const LightSphereList& in, const AABB& box, LightSphereList& out) {
+    forEachOverlap(in, box, [&](size_t i) {
+        out.push(in.x[i], in.y[i], in.depth[i], in.radius[i], in.index[i]);
+    });
+}
+
+void LightClusterGrid::setProjection(const glm::mat4& projection, float nearZ, float farZ) {
+    if (projection == cachedProjection && nearZ == nearPlane && farZ == farPlane) return;
+    cachedProjection = projection;
+    nearPlane = nearZ;
+    farPlane = farZ;
+
+    float logRatio = std::log(farPlane / nearPlane);
+    sliceScale = Slices / logRatio;
+    sliceBias = -Slices * std::log(nearPlane) / logRatio;
+
+    // A point at NDC (nx, ny) and view depth d sits at (nx * d / P00, ny * d / P11)
+    float invX = 1.0f / projection[0][0];
+    float invY = 1.0f / projection[1][1];
+    auto sliceDepth = [&](int slice) {
+        return nearPlane * std::pow(farPlane / nearPlane, static_cast<float>(slice) / Slices);
+    };
+    auto span = [](float ndc0, float ndc1, float dNear, float dFar, float scale, float& lo, float& hi) {
+        lo = std::min(ndc0 * dNear, ndc0 * dFar) * scale;
+        hi = std::max(ndc1 * dNear, ndc1 * dFar) * scale;
+    };
+
+    sliceBoxes.resize(Slices);
+    rowBoxes.resize(Slices * TilesY);
+    clusterBoxes.resize(ClusterCount);
+    for (int z = 0; z < Slices; z++) {
+        float dNear = sliceDepth(z);
+        float dFar = sliceDepth(z + 1);
+
+        AABB& slice = sliceBoxes[z];
+        span(-1.0f, 1.0f, dNear, dFar, invX, slice.min.x, slice.max.x);
+        span(-1.0f, 1.0f, dNear, dFar, invY, slice.min.y, slice.max.y);
+        slice.min.z = dNear;
+        slice.max.z = dFar;
+
+        for (int y = 0; y < TilesY; y++) {
+            AABB& row = rowBoxes[z * TilesY + y];
+            row = slice;
+            float ny = -1.0f + 2.0f * y / TilesY;
+            span(ny, ny + 2.0f / TilesY, dNear, dFar, invY, row.min.y, row.max.y);
+
+            for (int x = 0; x < TilesX; x++) {
+                AABB& cluster = clusterBoxes[(z * TilesY + y) * TilesX + x];
+                cluster = row;
+                float nx = -1.0f + 2.0f * x / TilesX;
+                span(nx, nx + 2.0f / TilesX, dNear, dFar, invX, cluster.min.x, cluster.max.x);
+            }
+        }
+    }
+}
+
+void LightClusterGrid::build(const std::vector<GPULight>& lights, const glm::mat4& view, JobSystem* jobs) {
+    clusterRanges.assign(2 * ClusterCount, 0);
+    lightIndices.clear();
+    maxLightsPerCluster = 0;
+    if (clusterBoxes.empty()) return;
+
+    // Bounding sphere of each light's influence, moved to view space
+    spheres.clear();
+    for (size_t i = 0; i < lights.size(); i++) {
+        const GPULight& light = lights[i];
+        glm::vec3 center(light.positionRange);
+        float range = light.positionRange.w;
+        float radius = range;
+
+        if (static_cast<int>(light.colorType.w) == static_cast<int>(LightType::Spot)) {
+            // Tightest sphere around the cone: narrow cones centre it on the axis past the
+            // midpoint, wide cones on the base disc
+            glm::vec3 dir(light.directionCosOuter);
+            float cosOuter = light.directionCosOuter.w;
+            if (cosOuter > 0.70710678f) {
+                radius = range / (2.0f * cosOuter);
+                center += dir * radius;
+            } else {
+                center += dir * (range * cosOuter);
+                radius = range * std::sqrt(std::max(0.0f, 1.0f - cosOuter * cosOuter));
+            }
+        }
+
+        glm::vec3 viewPos = glm::vec3(view * glm::vec4(center, 1.0f));
+        spheres.push(viewPos.x, viewPos.y, -viewPos.z, radius, static_cast<uint32_t>(i));
+    }
+
+    size_t workerCount = !jobs || lights.size() < ParallelLightThreshold ? 1 : std::min<size_t>(jobs->getWorkerCount() + 1, Slices);
+    work.resize(workerCount);
+
+    int slicesPerWorker = static_cast<int>((Slices + workerCount - 1) / workerCount);
+    parallelFor(jobs, workerCount, 1, [this, slicesPerWorker](size_t begin, size_t end) {
+        for (size_t w = begin; w < end; w++) {
+            int first = std::min(static_cast<int>(w) * slicesPerWorker, Slices);
+            binSlices(first, std::min(first + slicesPerWorker, Slices), work[w]);
+        }
+    });
+
+    // Each worker's offsets are relative to its own index list; stitch them in slice order
+    for (size_t w = 0; w < workerCount; w++) {
+        int first = std::min(static_cast<int>(w) * slicesPerWorker, Slices);
+        int end = std::min(first + slicesPerWorker, Slices);
+        uint32_t base = static_cast<uint32_t>(lightIndices.size());
+        for (int c = first * TilesX * TilesY; c < end * TilesX * TilesY; c++) {
+            clusterRanges[2 * c] += base;
+        }
+        lightIndices.insert(lightIndices.end(), work[w].indices.begin(), work[w].indices.end());
+        maxLightsPerCluster = std::max(maxLightsPerCluster, work[w].maxLights);
+    }
+}
+
+void LightClusterGrid::binSlices(int firstSlice, int endSlice, SliceWork& scratch) {
+    scratch.indices.clear();
+    scratch.maxLights = 0;
+
+    for (int z = firstSlice; z < endSlice; z++) {
+        scratch.sliceLights.clear();
+        filterLightSpheres(spheres, sliceBoxes[z], scratch.sliceLights);
+
+        for (int y = 0; y < TilesY; y++) {
+            scratch.rowLights.clear();
+            if (scratch.sliceLights.size() > 0) {
+                filterLightSpheres(scratch.sliceLights, rowBoxes[z * TilesY + y], scratch.rowLights);
+            }
+
+            for (int x = 0; x < TilesX; x++) {
+                int cluster = (z * TilesY + y) * TilesX + x;
+                uint32_t offset = static_cast<uint32_t>(scratch.indices.size());
+                const LightSphereList& rowLights = scratch.rowLights;
+                std::vector<uint32_t>& indices = scratch.indices;
+                forEachOverlap(rowLights, clusterBoxes[cluster], [&](size_t i) { indices.push_back(rowLights.index[i]); });
+                uint32_t count = static_cast<uint32_t>(scratch.indices.size()) - offset;
+                clusterRanges[2 * cluster] = offset;
+                clusterRanges[2 * cluster + 1] = count;
+                scratch.maxLights = std::max(scratch.maxLights, static_cast<int>(count));
+            }
+        }
+    }
+}
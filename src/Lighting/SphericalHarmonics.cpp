@@ -0,0 +1,144 @@
+#include "../../include/Lighting/SphericalHarmonics.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define SH_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SH_SSE 1
+#endif
+
+namespace {
+
+const float Pi = 3.14159265358979f;
+
+// The sample count is padded to a multiple of this, so the SIMD kernel never has a tail
+const size_t SampleAlignment = 8;
+// Samples per partial sum, a multiple of SampleAlignment. Fixed rather than derived from
+// the pool size so the summation order, and so the result, is the same on every machine.
+const size_t SamplesPerChunk = 512;
+
+void evaluateBasis(const glm::vec3& d, float* out) {
+    out[0] = 0.282095f;
+    out[1] = 0.488603f * d.y;
+    out[2] = 0.488603f * d.z;
+    out[3] = 0.488603f * d.x;
+    out[4] = 1.092548f * d.x * d.y;
+    out[5] = 1.092548f * d.y * d.z;
+    out[6] = 0.315392f * (3.0f * d.z * d.z - 1.0f);
+    out[7] = 1.092548f * d.x * d.z;
+    out[8] = 0.546274f * (d.x * d.x - d.y * d.y);
+}
+
+// Sum of weights[i] * values[i] over [begin, end)
+float dot(const float* weights, const float* values, size_t begin, size_t end) {
+    size_t i = begin;
+    float sum = 0.0f;
+#if defined(SH_AVX)
+    __m256 acc = _mm256_setzero_ps();
+    for (; i + 8 <= end; i += 8) {
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(weights + i), _mm256_loadu_ps(values + i)));
+    }
+    float lanes[8];
+    _mm256_storeu_ps(lanes, acc);
+    for (int lane = 0; lane < 8; lane++) sum += lanes[lane];
+#elif defined(SH_SSE)
+    __m128 acc = _mm_setzero_ps();
+    for (; i + 4 <= end; i += 4) {
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(weights + i), _mm_loadu_ps(values + i)));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, acc);
+    for (int lane = 0; lane < 4; lane++) sum += lanes[lane];
+#endif
+    // Scalar tail (and the whole range on targets without SSE)
+    for (; i < end; i++) sum += weights[i] * values[i];
+    return sum;
+}
+
+} // namespace
+
+SHProjector::SHProjector(int count) {
+    sampleCount = static_cast<size_t>(std::max(count, 1));
+    paddedCount = (sampleCount + SampleAlignment - 1) / SampleAlignment * SampleAlignment;
+
+    directions.resize(sampleCount);
+    basis.assign(9 * paddedCount, 0.0f);
+    radianceR.assign(paddedCount, 0.0f);
+    radianceG.assign(paddedCount, 0.0f);
+    radianceB.assign(paddedCount, 0.0f);
+
+    // Fibonacci sphere: equal-area samples, so every sample carries the same solid angle
+    const float goldenAngle = Pi * (3.0f - std::sqrt(5.0f));
+    for (size_t i = 0; i < sampleCount; i++) {
+        float z = 1.0f - (2.0f * i + 1.0f) / sampleCount;
+        float r = std::sqrt(std::max(0.0f, 1.0f - z * z));
+        float phi = goldenAngle * i;
+        directions[i] = glm::vec3(r * std::cos(phi), r * std::sin(phi), z);
+
+        float values[9];
+        evaluateBasis(directions[i], values);
+        for (int k = 0; k < 9; k++) basis[k * paddedCount + i] = values[k];
+    }
+}
+
+void SHProjector::projectRange(size_t begin, size_t end, const RadianceFunction& radiance, SH9& result) {
+    size_t last = std::min(end, sampleCount);
+    for (size_t i = begin; i < last; i++) {
+        glm::vec3 value = radiance(directions[i]);
+        radianceR[i] = value.r;
+        radianceG[i] = value.g;
+        radianceB[i] = value.b;
+    }
+
+    for (int k = 0; k < 9; k++) {
+        const float* row = basis.data() + k * paddedCount;
+        result.coefficients[k] = glm::vec3(dot(row, radianceR.data(), begin, end),
+                                           dot(row, radianceG.data(), begin, end),
+                                           dot(row, radianceB.data(), begin, end));
+    }
+}
+
+SH9 SHProjector::project(const RadianceFunction& radiance, JobSystem* jobs) {
+    size_t chunkCount = (paddedCount + SamplesPerChunk - 1) / SamplesPerChunk;
+    std::vector<SH9> partials(chunkCount);
+
+    // Chunks write disjoint ranges of the radiance arrays
+    parallelFor(jobs, chunkCount, 1, [this, &radiance, &partials](size_t first, size_t last) {
+        for (size_t c = first; c < last; c++) {
+            size_t begin = c * SamplesPerChunk;
+            projectRange(begin, std::min(begin + SamplesPerChunk, paddedCount), radiance, partials[c]);
+        }
+    });
+
+    // Reduce in chunk order so the result doesn't depend on thread timing
+    SH9 result = {};
+    const float sampleWeight = 4.0f * Pi / sampleCount;
+    for (int k = 0; k < 9; k++) {
+        glm::vec3 sum(0.0f);
+        for (const SH9& partial : partials) sum += partial.coefficients[k];
+        result.coefficients[k] = sum * sampleWeight;
+    }
+    return result;
+}
+
+SH9 convolveLambertian(const SH9& radiance) {
+    // Cosine lobe bands pi, 2pi/3, pi/4, each divided by pi for the Lambertian BRDF
+    const float band[3] = { 1.0f, 2.0f / 3.0f, 0.25f };
+    SH9 result;
+    for (int k = 0; k < 9; k++) {
+        int l = k == 0 ? 0 : (k < 4 ? 1 : 2);
+        result.coefficients[k] = radiance.coefficients[k] * band[l];
+    }
+    return result;
+}
+
+glm::vec3 evaluateSH9(const SH9& sh, const glm::vec3& direction) {
+    float values[9];
+    evaluateBasis(direction, values);
+    glm::vec3 result(0.0f);
+    for (int k = 0; k < 9; k++) result += sh.coefficients[k] * values[k];
+    return result;
+}
@@ -0,0 +1,175 @@
+#include "../../include/Profiling/CpuProfiler.h"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+struct ProfileEvent {
+    const char* name;
+    uint64_t start;
+    uint64_t end;
+};
+
+// Single producer: only the owning thread writes events and advances `written`.
+// Readers copy the ring and then keep only the events the producer can't have
+// overwritten while they were copying.
+struct ThreadBuffer {
+    std::unique_ptr<ProfileEvent[]> events;
+    std::atomic<uint64_t> written{ 0 };
+    uint32_t lane = 0;
+    std::string name;
+};
+
+// Buffers are never freed: a thread that exits hands its buffer to the next new thread,
+// so short-lived worker threads don't grow memory
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    std::vector<ThreadBuffer*> freeBuffers;
+    std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+struct ThreadSlot {
+    ThreadBuffer* buffer = nullptr;
+    ~ThreadSlot() {
+        if (!buffer) return;
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        reg.freeBuffers.push_back(buffer);
+    }
+};
+
+thread_local ThreadSlot threadSlot;
+
+ThreadBuffer& threadBuffer() {
+    if (threadSlot.buffer) return *threadSlot.buffer;
+
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    if (!reg.freeBuffers.empty()) {
+        // The previous thread's name and events would show up as this thread's
+        ThreadBuffer* buffer = reg.freeBuffers.back();
+        reg.freeBuffers.pop_back();
+        buffer->written.store(0, std::memory_order_relaxed);
+        buffer->name = "Thread " + std::to_string(buffer->lane);
+        threadSlot.buffer = buffer;
+    } else {
+        reg.buffers.push_back(std::make_unique<ThreadBuffer>());
+        ThreadBuffer* buffer = reg.buffers.back().get();
+        buffer->events.reset(new ProfileEvent[CpuProfiler::EventsPerThread]);
+        buffer->lane = static_cast<uint32_t>(reg.buffers.size());
+        buffer->name = "Thread " + std::to_string(buffer->lane);
+        threadSlot.buffer = buffer;
+    }
+    return *threadSlot.buffer;
+}
+
+// One thread's lane as copied out for writeChromeTrace()
+struct ThreadSnapshot {
+    uint32_t lane;
+    std::string name;
+    std::vector<ProfileEvent> events;
+};
+
+void writeEscaped(std::ostream& out, const char* text) {
+    for (const char* c = text; *c; c++) {
+        if (*c == '"' || *c == '\\') out << '\\';
+        out << *c;
+    }
+}
+
+} // namespace
+
+uint64_t CpuProfiler::now() {
+    auto elapsed = std::chrono::steady_clock::now() - registry().epoch;
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+}
+
+void CpuProfiler::record(const char* name, uint64_t start, uint64_t end) {
+    ThreadBuffer& buffer = threadBuffer();
+    uint64_t index = buffer.written.load(std::memory_order_relaxed);
+    buffer.events[index % EventsPerThread] = { name, start, end };
+    buffer.written.store(index + 1, std::memory_order_release);
+}
+
+void CpuProfiler::setThreadName(const char* name) {
+    ThreadBuffer& buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    buffer.name = name;
+}
+
+bool CpuProfiler::writeChromeTrace(const std::string& path, double seconds, size_t* eventsWritten) {
+    uint64_t cutoff = 0;
+    uint64_t current = now();
+    uint64_t window = static_cast<uint64_t>(seconds * 1e9);
+    if (current > window) cutoff = current - window;
+
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Failed to write trace: " << path << std::endl;
+        return false;
+    }
+
+    // Copy the events out under the lock and write the file after releasing it, so
+    // threads starting up meanwhile don't wait on the disk
+    std::vector<ThreadSnapshot> threads;
+    {
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        std::vector<ProfileEvent> ring(EventsPerThread);
+        threads.reserve(reg.buffers.size());
+
+        for (const auto& buffer : reg.buffers) {
+            threads.push_back({ buffer->lane, buffer->name, {} });
+            ThreadSnapshot& thread = threads.back();
+
+            uint64_t before = buffer->written.load(std::memory_order_acquire);
+            uint64_t first = before > EventsPerThread ? before - EventsPerThread : 0;
+            for (uint64_t i = first; i < before; i++) {
+                ring[i % EventsPerThread] = buffer->events[i % EventsPerThread];
+            }
+            // The producer may have reused the oldest slots during the copy, and the slot it
+            // writes next could be half written
+            uint64_t after = buffer->written.load(std::memory_order_acquire);
+            if (after + 1 > first + EventsPerThread) first = after + 1 - EventsPerThread;
+
+            for (uint64_t i = first; i < before; i++) {
+                const ProfileEvent& event = ring[i % EventsPerThread];
+                if (event.end >= cutoff) thread.events.push_back(event);
+            }
+        }
+    }
+
+    size_t count = 0;
+    file << "{\"traceEvents\":[\n";
+    file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"Modularity\"}}";
+
+    for (const ThreadSnapshot& thread : threads) {
+        file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread.lane << ",\"args\":{\"name\":\"";
+        writeEscaped(file, thread.name.c_str());
+        file << "\"}}";
+
+        for (const ProfileEvent& event : thread.events) {
+            file << ",\n{\"name\":\"";
+            writeEscaped(file, event.name);
+            file << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread.lane
+                 << ",\"ts\":" << event.start / 1000 << "." << event.start % 1000 / 100
+                 << ",\"dur\":" << (event.end - event.start) / 1000 << "." << (event.end - event.start) % 1000 / 100 << "}";
+            count++;
+        }
+    }
+
+    file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    if (eventsWritten) *eventsWritten = count;
+    return file.good();
+}
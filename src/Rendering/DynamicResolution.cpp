@@ -0,0 +1,81 @@
+#include "../../include/Rendering/DynamicResolution.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Aim below the budget so small spikes don't immediately miss it
+const float Headroom = 0.9f;
+// Only grow when the estimate clears the current scale by this much, so the scale
+// doesn't hover back and forth across one size
+const float GrowDeadband = 0.02f;
+// Largest change per measured frame: shrink quickly when over budget, grow slowly
+const float MaxShrinkStep = 0.1f;
+const float MaxGrowStep = 0.02f;
+
+} // namespace
+
+DynamicResolution::DynamicResolution() {
+    glGenQueries(QueryCount, queries);
+    for (int i = 0; i < QueryCount; i++) queryScales[i] = MaxScale;
+}
+
+DynamicResolution::~DynamicResolution() {
+    glDeleteQueries(QueryCount, queries);
+}
+
+void DynamicResolution::beginTiming() {
+    if (pendingCount == QueryCount) return;
+    queryScales[nextQuery] = getScale();
+    glBeginQuery(GL_TIME_ELAPSED, queries[nextQuery]);
+    timing = true;
+}
+
+void DynamicResolution::endTiming() {
+    if (!timing) return;
+    glEndQuery(GL_TIME_ELAPSED);
+    timing = false;
+    nextQuery = (nextQuery + 1) % QueryCount;
+    pendingCount++;
+}
+
+void DynamicResolution::update() {
+    // Results arrive in submission order, so stop at the first one still in flight
+    while (pendingCount > 0) {
+        int oldest = (nextQuery - pendingCount + QueryCount) % QueryCount;
+        GLint available = 0;
+        glGetQueryObjectiv(queries[oldest], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) break;
+
+        GLuint64 nanoseconds = 0;
+        glGetQueryObjectui64v(queries[oldest], GL_QUERY_RESULT, &nanoseconds);
+        pendingCount--;
+
+        gpuTime = static_cast<float>(nanoseconds) * 1e-6f;
+        if (enabled) adjust(queryScales[oldest], gpuTime);
+    }
+}
+
+void DynamicResolution::adjust(float measuredScale, float milliseconds) {
+    // Cost is taken as proportional to the pixel count. The estimate is made from the
+    // scale the query measured, not the current one, because results lag a few frames.
+    float target = budget * Headroom;
+    float desired = measuredScale * std::sqrt(target / std::max(milliseconds, 0.01f));
+    desired = std::clamp(desired, MinScale, MaxScale);
+
+    if (desired < scale) {
+        scale = std::max(desired, scale - MaxShrinkStep);
+    } else if (desired > scale + GrowDeadband) {
+        scale = std::min(desired, scale + MaxGrowStep);
+    }
+}
+
+void DynamicResolution::setEnabled(bool enable) {
+    if (enable && !enabled) scale = MaxScale;
+    enabled = enable;
+}
+
+void DynamicResolution::setBudget(float milliseconds) {
+    budget = std::max(milliseconds, 1.0f);
+}
@@ -0,0 +1,118 @@
+#include "../../include/Rendering/GLStateCache.h"
+#include <glad/glad.h>
+#include <iostream>
+
+bool GLStateCache::changed(unsigned int& cached, unsigned int value) {
+    if (cached == value) {
+        skippedCount++;
+        return false;
+    }
+    cached = value;
+    issuedCount++;
+    return true;
+}
+
+void GLStateCache::useProgram(unsigned int newProgram) {
+    if (changed(program, newProgram)) glUseProgram(newProgram);
+}
+
+void GLStateCache::bindVertexArray(unsigned int newVertexArray) {
+    if (changed(vertexArray, newVertexArray)) glBindVertexArray(newVertexArray);
+}
+
+void GLStateCache::bindArrayBuffer(unsigned int buffer) {
+    if (changed(arrayBuffer, buffer)) glBindBuffer(GL_ARRAY_BUFFER, buffer);
+}
+
+void GLStateCache::activeTexture(unsigned int unit) {
+    // Not counted: it only matters together with the bind it precedes
+    if (activeUnit != unit) {
+        activeUnit = unit;
+        glActiveTexture(GL_TEXTURE0 + unit);
+    }
+}
+
+void GLStateCache::bindTexture(unsigned int unit, unsigned int target, unsigned int texture) {
+    unsigned int* slot = nullptr;
+    if (unit < MaxTextureUnits) {
+        if (target == GL_TEXTURE_2D) slot = &textures2D[unit];
+        else if (target == GL_TEXTURE_CUBE_MAP) slot = &texturesCube[unit];
+        else if (target == GL_TEXTURE_BUFFER) slot = &texturesBuffer[unit];
+        else if (target == GL_TEXTURE_2D_ARRAY) slot = &texturesArray[unit];
+    }
+
+    if (!slot) {
+        activeTexture(unit);
+        glBindTexture(target, texture);
+        issuedCount++;
+        return;
+    }
+
+    if (changed(*slot, texture)) {
+        activeTexture(unit);
+        glBindTexture(target, texture);
+    }
+}
+
+void GLStateCache::setDepthFunc(unsigned int func) {
+    if (changed(depthFunc, func)) glDepthFunc(func);
+}
+
+void GLStateCache::bindFramebuffer(unsigned int newFramebuffer) {
+    if (changed(framebuffer, newFramebuffer)) glBindFramebuffer(GL_FRAMEBUFFER, newFramebuffer);
+}
+
+bool GLStateCache::validate() {
+#ifdef MODULARITY_GL_VALIDATION
+    bool valid = true;
+    auto check = [&valid](const char* name, unsigned int cached, GLenum query) {
+        if (cached == Unknown) return;
+        GLint actual = 0;
+        glGetIntegerv(query, &actual);
+        if (static_cast<unsigned int>(actual) != cached) {
+            std::cerr << "GL state mismatch: " << name << " cached " << cached << ", actual " << actual << "\n";
+            valid = false;
+        }
+    };
+
+    check("program", program, GL_CURRENT_PROGRAM);
+    check("vertex array", vertexArray, GL_VERTEX_ARRAY_BINDING);
+    check("array buffer", arrayBuffer, GL_ARRAY_BUFFER_BINDING);
+    check("framebuffer", framebuffer, GL_FRAMEBUFFER_BINDING);
+    check("depth func", depthFunc, GL_DEPTH_FUNC);
+    if (activeUnit != Unknown) check("active texture", GL_TEXTURE0 + activeUnit, GL_ACTIVE_TEXTURE);
+
+    GLint restoreUnit = 0;
+    glGetIntegerv(GL_ACTIVE_TEXTURE, &restoreUnit);
+    for (unsigned int unit = 0; unit < MaxTextureUnits; unit++) {
+        if (textures2D[unit] == Unknown && texturesCube[unit] == Unknown && texturesBuffer[unit] == Unknown &&
+            texturesArray[unit] == Unknown) continue;
+        glActiveTexture(GL_TEXTURE0 + unit);
+        check("texture 2D", textures2D[unit], GL_TEXTURE_BINDING_2D);
+        check("texture cube", texturesCube[unit], GL_TEXTURE_BINDING_CUBE_MAP);
+        check("texture buffer", texturesBuffer[unit], GL_TEXTURE_BINDING_BUFFER);
+        check("texture 2D array", texturesArray[unit], GL_TEXTURE_BINDING_2D_ARRAY);
+    }
+    glActiveTexture(static_cast<GLenum>(restoreUnit));
+
+    invalidate();
+    return valid;
+#else
+    return true;
+#endif
+}
+
+void GLStateCache::invalidate() {
+    program = Unknown;
+    vertexArray = Unknown;
+    arrayBuffer = Unknown;
+    activeUnit = Unknown;
+    for (unsigned int i = 0; i < MaxTextureUnits; i++) {
+        textures2D[i] = Unknown;
+        texturesCube[i] = Unknown;
+        texturesBuffer[i] = Unknown;
+        texturesArray[i] = Unknown;
+    }
+    depthFunc = Unknown;
+    framebuffer = Unknown;
+}
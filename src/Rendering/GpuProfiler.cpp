@@ -0,0 +1,123 @@
+#include "../../include/Rendering/GpuProfiler.h"
+#include <glad/glad.h>
+#include <algorithm>
+
+GpuProfiler::~GpuProfiler() {
+    for (Frame& frame : frames) {
+        if (!frame.queries.empty()) glDeleteQueries(static_cast<GLsizei>(frame.queries.size()), frame.queries.data());
+    }
+}
+
+void GpuProfiler::beginFrame() {
+    // Oldest first; later frames can't have finished before an earlier one
+    for (int i = 1; i <= FrameLatency; i++) {
+        Frame& frame = frames[(current + i) % FrameLatency];
+        if (frame.pending && !readFrame(frame)) break;
+    }
+
+    if (!enabled) return;
+
+    current = (current + 1) % FrameLatency;
+    Frame& frame = frames[current];
+    if (frame.pending) {
+        droppedFrames++;
+        frame.pending = false;
+    }
+    frame.usedQueries = 0;
+    frame.scopes.clear();
+
+    recording = true;
+    frameScope = beginScope("Frame");
+}
+
+void GpuProfiler::endFrame() {
+    if (!recording) return;
+    endScope(frameScope);
+    frames[current].pending = true;
+    recording = false;
+}
+
+int GpuProfiler::beginScope(const char* name) {
+    if (!recording) return -1;
+    Frame& frame = frames[current];
+    Scope scope;
+    scope.pass = findPass(name);
+    scope.beginQuery = timestamp(frame);
+    frame.scopes.push_back(scope);
+    return static_cast<int>(frame.scopes.size()) - 1;
+}
+
+void GpuProfiler::endScope(int scope) {
+    if (scope < 0 || !recording) return;
+    Frame& frame = frames[current];
+    frame.scopes[scope].endQuery = timestamp(frame);
+}
+
+int GpuProfiler::findPass(const char* name) {
+    for (size_t i = 0; i < passes.size(); i++) {
+        if (passes[i].name == name) return static_cast<int>(i);
+    }
+    passes.emplace_back();
+    passes.back().name = name;
+    return static_cast<int>(passes.size()) - 1;
+}
+
+int GpuProfiler::timestamp(Frame& frame) {
+    if (frame.usedQueries == static_cast<int>(frame.queries.size())) {
+        unsigned int query;
+        glGenQueries(1, &query);
+        frame.queries.push_back(query);
+    }
+    glQueryCounter(frame.queries[frame.usedQueries], GL_TIMESTAMP);
+    return frame.usedQueries++;
+}
+
+bool GpuProfiler::readFrame(Frame& frame) {
+    for (int q = 0; q < frame.usedQueries; q++) {
+        GLint available = 0;
+        glGetQueryObjectiv(frame.queries[q], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) return false;
+    }
+
+    frameTimes.assign(passes.size(), 0.0f);
+    for (const Scope& scope : frame.scopes) {
+        if (scope.endQuery < 0) continue;
+        GLuint64 begin = 0, end = 0;
+        glGetQueryObjectui64v(frame.queries[scope.beginQuery], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(frame.queries[scope.endQuery], GL_QUERY_RESULT, &end);
+        if (end > begin) frameTimes[scope.pass] += static_cast<float>(end - begin) * 1e-6f;
+    }
+
+    // Every pass gets a sample per frame so the graphs stay aligned; absent passes read 0
+    for (size_t p = 0; p < passes.size(); p++) {
+        PassHistory& pass = passes[p];
+        pass.samples[pass.next] = frameTimes[p];
+        pass.next = (pass.next + 1) % HistoryLength;
+        pass.count = std::min(pass.count + 1, HistoryLength);
+        pass.latest = frameTimes[p];
+    }
+    frame.pending = false;
+    return true;
+}
+
+GpuProfiler::PassStats GpuProfiler::computeStats(const PassHistory& pass) const {
+    PassStats stats;
+    if (pass.count == 0) return stats;
+
+    sorted.assign(pass.samples, pass.samples + pass.count);
+    std::sort(sorted.begin(), sorted.end());
+
+    float sum = 0.0f;
+    for (float sample : sorted) sum += sample;
+    stats.average = sum / pass.count;
+
+    auto percentile = [this](float p) {
+        size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5f);
+        return sorted[std::min(index, sorted.size() - 1)];
+    };
+    stats.p50 = percentile(0.50f);
+    stats.p95 = percentile(0.95f);
+    stats.p99 = percentile(0.99f);
+    stats.max = sorted.back();
+    return stats;
+}
@@ -0,0 +1,54 @@
+#include "../../include/Rendering/RenderQueue.h"
+#include <algorithm>
+
+namespace RenderKey {
+
+uint64_t make(unsigned int pass, unsigned int shader, unsigned int textureSet, unsigned int vertexArray, float depth) {
+    const uint64_t depthMax = (1ull << DepthBits) - 1;
+    float clamped = std::min(std::max(depth, 0.0f), 1.0f);
+    uint64_t quantizedDepth = static_cast<uint64_t>(clamped * static_cast<float>(depthMax));
+
+    uint64_t key = 0;
+    key |= (uint64_t(pass) & ((1ull << PassBits) - 1)) << (64 - PassBits);
+    key |= (uint64_t(shader) & ((1ull << ShaderBits) - 1)) << (64 - PassBits - ShaderBits);
+    key |= (uint64_t(textureSet) & ((1ull << TextureSetBits) - 1)) << (DepthBits + VertexArrayBits);
+    key |= (uint64_t(vertexArray) & ((1ull << VertexArrayBits) - 1)) << DepthBits;
+    key |= std::min(quantizedDepth, depthMax);
+    return key;
+}
+
+unsigned int pass(uint64_t key) {
+    return static_cast<unsigned int>(key >> (64 - PassBits));
+}
+
+} // namespace RenderKey
+
+void RenderQueue::sort() {
+    const size_t count = commands.size();
+    if (count < 2) return;
+
+    // All eight byte histograms in a single sweep
+    size_t histograms[8][256] = {};
+    for (const RenderCommand& command : commands) {
+        for (int b = 0; b < 8; b++) histograms[b][(command.key >> (b * 8)) & 0xFF]++;
+    }
+
+    scratch.resize(count);
+    for (int b = 0; b < 8; b++) {
+        size_t* histogram = histograms[b];
+        uint8_t firstByte = static_cast<uint8_t>((commands[0].key >> (b * 8)) & 0xFF);
+        if (histogram[firstByte] == count) continue;
+
+        size_t offset = 0;
+        for (int i = 0; i < 256; i++) {
+            size_t bucket = histogram[i];
+            histogram[i] = offset;
+            offset += bucket;
+        }
+
+        for (const RenderCommand& command : commands) {
+            scratch[histogram[(command.key >> (b * 8)) & 0xFF]++] = command;
+        }
+        commands.swap(scratch);
+    }
+}
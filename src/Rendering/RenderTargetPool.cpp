@@ -0,0 +1,171 @@
+#include "../../include/Rendering/RenderTargetPool.h"
+#include "../../include/Rendering/GLStateCache.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <iostream>
+
+namespace {
+
+// Client format and type for allocating a sized internal format without data
+void uploadFormat(unsigned int internalFormat, unsigned int& format, unsigned int& type) {
+    switch (internalFormat) {
+        case GL_RGBA8: format = GL_RGBA; type = GL_UNSIGNED_BYTE; break;
+        case GL_RGBA16F: format = GL_RGBA; type = GL_HALF_FLOAT; break;
+        case GL_R11F_G11F_B10F: format = GL_RGB; type = GL_FLOAT; break;
+        case GL_DEPTH24_STENCIL8: format = GL_DEPTH_STENCIL; type = GL_UNSIGNED_INT_24_8; break;
+        case GL_DEPTH_COMPONENT24: format = GL_DEPTH_COMPONENT; type = GL_FLOAT; break;
+        default: format = GL_RGB; type = GL_UNSIGNED_BYTE; break;
+    }
+}
+
+} // namespace
+
+RenderTargetPool::~RenderTargetPool() {
+    for (auto& target : targets) destroy(*target);
+}
+
+int RenderTargetPool::bucket(int size) {
+    return std::max(1, (size + BucketSize - 1) / BucketSize) * BucketSize;
+}
+
+void RenderTargetPool::beginFrame(GLStateCache& state) {
+    frameIndex++;
+
+    size_t before = targets.size();
+    targets.erase(std::remove_if(targets.begin(), targets.end(), [this](const std::unique_ptr<RenderTarget>& target) {
+        if (target->inUse || frameIndex - target->lastUsedFrame < FreeAfterFrames) return false;
+        destroy(*target);
+        return true;
+    }), targets.end());
+
+    // Deleting a bound texture unbinds it, and its name may be handed out again
+    if (targets.size() != before) state.invalidate();
+}
+
+int RenderTargetPool::createSlot(const RenderTargetDesc& desc) {
+    Slot slot;
+    slot.desc = desc;
+    slots.push_back(slot);
+    return static_cast<int>(slots.size()) - 1;
+}
+
+RenderTargetView RenderTargetPool::resolveSlot(GLStateCache& state, int slotIndex, int width, int height) {
+    Slot& slot = slots[slotIndex];
+    width = std::max(width, 1);
+    height = std::max(height, 1);
+
+    if (width != slot.requestedWidth || height != slot.requestedHeight) {
+        slot.requestedWidth = width;
+        slot.requestedHeight = height;
+        slot.stableFrames = 0;
+    } else {
+        slot.stableFrames++;
+    }
+
+    bool moveBucket = false;
+    if (slot.target) {
+        bool wrongBucket = slot.target->width != bucket(width) || slot.target->height != bucket(height);
+        moveBucket = wrongBucket && slot.stableFrames >= StableFrames;
+    }
+    if (!slot.target || moveBucket) {
+        if (slot.target) slot.target->inUse = false;
+        slot.target = findOrCreate(state, slot.desc, width, height);
+    }
+
+    slot.target->lastUsedFrame = frameIndex;
+    return makeView(slot.target, width, height);
+}
+
+bool RenderTargetPool::isSlotSettled(int slotIndex) const {
+    const Slot& slot = slots[slotIndex];
+    return slot.target && slot.target->width == bucket(slot.requestedWidth) &&
+           slot.target->height == bucket(slot.requestedHeight);
+}
+
+RenderTargetView RenderTargetPool::acquire(GLStateCache& state, const RenderTargetDesc& desc, int width, int height) {
+    width = std::max(width, 1);
+    height = std::max(height, 1);
+    RenderTarget* target = findOrCreate(state, desc, width, height);
+    target->lastUsedFrame = frameIndex;
+    return makeView(target, width, height);
+}
+
+void RenderTargetPool::release(const RenderTarget* released) {
+    for (auto& target : targets) {
+        if (target.get() == released) target->inUse = false;
+    }
+}
+
+RenderTarget* RenderTargetPool::findOrCreate(GLStateCache& state, const RenderTargetDesc& desc, int width, int height) {
+    int bucketWidth = bucket(width);
+    int bucketHeight = bucket(height);
+    for (auto& target : targets) {
+        if (!target->inUse && target->desc == desc && target->width == bucketWidth && target->height == bucketHeight) {
+            target->inUse = true;
+            return target.get();
+        }
+    }
+
+    targets.push_back(std::make_unique<RenderTarget>());
+    RenderTarget& target = *targets.back();
+    target.desc = desc;
+    target.width = bucketWidth;
+    target.height = bucketHeight;
+    target.inUse = true;
+    allocate(state, target);
+    return &target;
+}
+
+void RenderTargetPool::allocate(GLStateCache& state, RenderTarget& target) {
+    allocationCount++;
+    glGenFramebuffers(1, &target.framebuffer);
+    state.bindFramebuffer(target.framebuffer);
+
+    unsigned int format, type;
+    if (target.desc.colorFormat) {
+        glGenTextures(1, &target.colorTexture);
+        state.bindTexture(0, GL_TEXTURE_2D, target.colorTexture);
+        uploadFormat(target.desc.colorFormat, format, type);
+        glTexImage2D(GL_TEXTURE_2D, 0, target.desc.colorFormat, target.width, target.height, 0, format, type, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target.colorTexture, 0);
+    } else {
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+    }
+
+    if (target.desc.depthFormat) {
+        glGenTextures(1, &target.depthTexture);
+        state.bindTexture(0, GL_TEXTURE_2D, target.depthTexture);
+        uploadFormat(target.desc.depthFormat, format, type);
+        glTexImage2D(GL_TEXTURE_2D, 0, target.desc.depthFormat, target.width, target.height, 0, format, type, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        unsigned int attachment = target.desc.depthFormat == GL_DEPTH24_STENCIL8 ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+        glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, target.depthTexture, 0);
+    }
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Render target " << target.width << "x" << target.height << " incomplete!\n";
+    }
+}
+
+void RenderTargetPool::destroy(RenderTarget& target) {
+    glDeleteFramebuffers(1, &target.framebuffer);
+    if (target.colorTexture) glDeleteTextures(1, &target.colorTexture);
+    if (target.depthTexture) glDeleteTextures(1, &target.depthTexture);
+}
+
+RenderTargetView RenderTargetPool::makeView(RenderTarget* target, int width, int height) {
+    RenderTargetView view;
+    view.target = target;
+    view.width = std::min(width, target->width);
+    view.height = std::min(height, target->height);
+    view.uvScale = glm::vec2(static_cast<float>(view.width) / target->width, static_cast<float>(view.height) / target->height);
+    return view;
+}
@@ -0,0 +1,112 @@
+#include "../../include/Rendering/TemporalUpsampler.h"
+#include "../../include/Rendering/GLStateCache.h"
+#include "../../include/Shaders/Shader.h"
+#include <glad/glad.h>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+enum ResolveTextureUnit { SceneColorUnit = 0, SceneDepthUnit = 1, HistoryUnit = 2 };
+
+float halton(int index, int base) {
+    float result = 0.0f;
+    float fraction = 1.0f / base;
+    while (index > 0) {
+        result += fraction * (index % base);
+        index /= base;
+        fraction /= base;
+    }
+    return result;
+}
+
+} // namespace
+
+TemporalUpsampler::TemporalUpsampler(RenderTargetPool& targetPool) : pool(targetPool) {
+    shader = new Shader("Resources/Shaders/temporal_upsample_vert.glsl", "Resources/Shaders/temporal_upsample_frag.glsl");
+    if (shader->ID == 0) {
+        std::cerr << "Temporal upsample shader compilation failed!\n";
+        delete shader;
+        throw std::runtime_error("Shader error");
+    }
+    shader->use();
+    shader->setInt("sceneColor", SceneColorUnit);
+    shader->setInt("sceneDepth", SceneDepthUnit);
+    shader->setInt("history", HistoryUnit);
+    inputSizeLocation = shader->getUniformLocation("inputSize");
+    outputSizeLocation = shader->getUniformLocation("outputSize");
+    jitterLocation = shader->getUniformLocation("jitter");
+    reprojectionLocation = shader->getUniformLocation("reprojection");
+    historyWeightLocation = shader->getUniformLocation("historyWeight");
+
+    glGenVertexArrays(1, &emptyVAO);
+
+    // Half float so the slow history blend doesn't band in dark gradients
+    RenderTargetDesc desc;
+    desc.colorFormat = GL_RGBA16F;
+    historySlots[0] = pool.createSlot(desc);
+    historySlots[1] = pool.createSlot(desc);
+}
+
+TemporalUpsampler::~TemporalUpsampler() {
+    delete shader;
+    glDeleteVertexArrays(1, &emptyVAO);
+}
+
+glm::vec2 TemporalUpsampler::getJitter(unsigned long long frameIndex) {
+    int index = static_cast<int>(frameIndex % JitterSequenceLength) + 1;
+    return glm::vec2(halton(index, 2) - 0.5f, halton(index, 3) - 0.5f);
+}
+
+glm::mat4 TemporalUpsampler::jitterProjection(const glm::mat4& projection, const glm::vec2& jitter, int renderWidth, int renderHeight) {
+    // The z column reaches x and y after the divide by -z, so this is a constant NDC
+    // offset of -2 * jitter / size: pixel centre i then samples the scene at i + 0.5 + jitter
+    glm::mat4 jittered = projection;
+    jittered[2][0] += 2.0f * jitter.x / renderWidth;
+    jittered[2][1] += 2.0f * jitter.y / renderHeight;
+    return jittered;
+}
+
+void TemporalUpsampler::resolve(GLStateCache& state, const RenderTargetView& scene, int outputWidth, int outputHeight,
+                                const glm::vec2& jitter, const glm::mat4& viewProjection) {
+    int previous = current;
+    current = 1 - current;
+
+    // Both buffers are requested every frame so they always sit in the same bucket
+    RenderTargetView previousView = history[previous];
+    history[0] = pool.resolveSlot(state, historySlots[0], outputWidth, outputHeight);
+    history[1] = pool.resolveSlot(state, historySlots[1], outputWidth, outputHeight);
+    const RenderTargetView& output = history[current];
+
+    // The history is only usable at the same size and in the same allocation
+    if (!previousView.target || previousView.width != output.width || previousView.height != output.height ||
+        previousView.target != history[previous].target) {
+        historyValid = false;
+    }
+
+    state.bindFramebuffer(output.target->framebuffer);
+    glViewport(0, 0, output.width, output.height);
+    state.useProgram(shader->ID);
+    state.bindTexture(SceneColorUnit, GL_TEXTURE_2D, scene.target->colorTexture);
+    state.bindTexture(SceneDepthUnit, GL_TEXTURE_2D, scene.target->depthTexture);
+    state.bindTexture(HistoryUnit, GL_TEXTURE_2D, history[previous].target->colorTexture);
+    state.bindVertexArray(emptyVAO);
+
+    // Current clip space straight to last frame's; the jitter only moves x and y, so the
+    // unjittered inverse still matches the depth buffer
+    glm::mat4 reprojection = previousViewProjection * glm::inverse(viewProjection);
+
+    // Scene and history both use only the lower-left corner of their targets
+    shader->setVec2(inputSizeLocation, glm::vec2(scene.width, scene.height));
+    shader->setVec4(outputSizeLocation, glm::vec4(output.width, output.height,
+                                                  1.0f / output.target->width, 1.0f / output.target->height));
+    shader->setVec2(jitterLocation, jitter);
+    shader->setMat4(reprojectionLocation, reprojection);
+    shader->setFloat(historyWeightLocation, historyValid ? 1.0f : 0.0f);
+
+    // The output has no depth attachment, so the depth test always passes
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    previousViewProjection = viewProjection;
+    historyValid = true;
+}
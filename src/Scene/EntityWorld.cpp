@@ -0,0 +1,198 @@
+#include "../../include/Scene/EntityWorld.h"
+#include <atomic>
+#include <cassert>
+
+namespace {
+
+ComponentInfo componentInfos[ComponentRegistry::MaxComponents];
+std::atomic<int> componentCount{ 0 };
+
+size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+int ComponentRegistry::add(const ComponentInfo& info) {
+    int id = componentCount.fetch_add(1);
+    assert(id < MaxComponents && "Too many component types");
+    componentInfos[id] = info;
+    return id;
+}
+
+const ComponentInfo& ComponentRegistry::get(int id) {
+    return componentInfos[id];
+}
+
+void EntityWorld::Archetype::destroyRows() {
+    for (Chunk& chunk : chunks) {
+        for (size_t column = 0; column < components.size(); column++) {
+            const ComponentInfo& info = ComponentRegistry::get(components[column]);
+            for (size_t row = 0; row < chunk.count; row++) info.destroy(component(chunk, static_cast<int>(column), row));
+        }
+        chunk.count = 0;
+    }
+    chunks.clear();
+    entityCount = 0;
+}
+
+void EntityWorld::destroy(Entity entity) {
+    Location* location = entities.get(entity);
+    if (!location) return;
+
+    Archetype& archetype = *location->archetype;
+    Chunk& chunk = archetype.chunks[location->chunk];
+    for (size_t column = 0; column < archetype.components.size(); column++) {
+        ComponentRegistry::get(archetype.components[column]).destroy(archetype.component(chunk, static_cast<int>(column), location->row));
+    }
+    removeRow(archetype, location->chunk, location->row);
+    entities.erase(entity);
+}
+
+void EntityWorld::clear() {
+    for (const std::unique_ptr<Archetype>& archetype : archetypes) archetype->destroyRows();
+    entities.clear();
+}
+
+EntityWorld::Archetype& EntityWorld::getArchetype(ComponentMask mask) {
+    auto it = archetypesByMask.find(mask);
+    if (it != archetypesByMask.end()) return *it->second;
+
+    std::unique_ptr<Archetype> archetype(new Archetype());
+    archetype->mask = mask;
+    for (int id = 0; id < ComponentRegistry::MaxComponents; id++) {
+        archetype->columnOf[id] = -1;
+        if (mask & (ComponentMask(1) << id)) {
+            archetype->columnOf[id] = static_cast<int>(archetype->components.size());
+            archetype->components.push_back(id);
+        }
+    }
+
+    // As many rows as fit in a chunk, at least one
+    size_t rowBytes = sizeof(Entity);
+    for (int id : archetype->components) rowBytes += ComponentRegistry::get(id).size;
+    size_t capacity = std::max<size_t>(1, ChunkBytes / rowBytes);
+    while (true) {
+        size_t offset = capacity * sizeof(Entity);
+        archetype->columnOffsets.clear();
+        for (int id : archetype->components) {
+            const ComponentInfo& info = ComponentRegistry::get(id);
+            offset = alignUp(offset, info.align);
+            archetype->columnOffsets.push_back(offset);
+            offset += capacity * info.size;
+        }
+        if (offset <= ChunkBytes || capacity == 1) {
+            archetype->capacity = capacity;
+            archetype->chunkBytes = std::max(offset, sizeof(Entity));
+            break;
+        }
+        capacity--;
+    }
+
+    Archetype* created = archetype.get();
+    archetypes.push_back(std::move(archetype));
+    archetypesByMask[mask] = created;
+    for (auto& entry : queries) {
+        if ((mask & entry.first) == entry.first) entry.second.push_back(created);
+    }
+    return *created;
+}
+
+EntityWorld::Archetype& EntityWorld::getNeighbour(Archetype& archetype, int component) {
+    auto it = archetype.edges.find(component);
+    if (it != archetype.edges.end()) return *it->second;
+
+    Archetype& neighbour = getArchetype(archetype.mask ^ (ComponentMask(1) << component));
+    archetype.edges[component] = &neighbour;
+    neighbour.edges[component] = &archetype;
+    return neighbour;
+}
+
+const std::vector<EntityWorld::Archetype*>& EntityWorld::query(ComponentMask mask) const {
+    auto it = queries.find(mask);
+    if (it != queries.end()) return it->second;
+
+    std::vector<Archetype*>& matching = queries[mask];
+    for (const std::unique_ptr<Archetype>& archetype : archetypes) {
+        if ((archetype->mask & mask) == mask) matching.push_back(archetype.get());
+    }
+    return matching;
+}
+
+void* EntityWorld::find(Entity entity, int component) {
+    Location* location = entities.get(entity);
+    if (!location) return nullptr;
+    int column = location->archetype->columnOf[component];
+    if (column < 0) return nullptr;
+    return location->archetype->component(location->archetype->chunks[location->chunk], column, location->row);
+}
+
+Entity EntityWorld::allocate(Archetype& archetype) {
+    Location location;
+    location.archetype = &archetype;
+    reserveRow(archetype, location.chunk, location.row);
+    Entity entity = entities.insert(location);
+    new (archetype.entities(archetype.chunks[location.chunk]) + location.row) Entity(entity);
+    return entity;
+}
+
+void EntityWorld::move(Entity entity, Archetype& target) {
+    Location& location = *entities.get(entity);
+    Archetype& source = *location.archetype;
+    Chunk& sourceChunk = source.chunks[location.chunk];
+
+    uint32_t chunkIndex, row;
+    reserveRow(target, chunkIndex, row);
+    Chunk& targetChunk = target.chunks[chunkIndex];
+    new (target.entities(targetChunk) + row) Entity(entity);
+
+    for (size_t column = 0; column < source.components.size(); column++) {
+        int id = source.components[column];
+        const ComponentInfo& info = ComponentRegistry::get(id);
+        void* component = source.component(sourceChunk, static_cast<int>(column), location.row);
+        if (target.columnOf[id] >= 0) {
+            info.moveConstruct(target.component(targetChunk, target.columnOf[id], row), component);
+        }
+        info.destroy(component);
+    }
+
+    removeRow(source, location.chunk, location.row);
+    location.archetype = &target;
+    location.chunk = chunkIndex;
+    location.row = row;
+}
+
+void EntityWorld::reserveRow(Archetype& archetype, uint32_t& chunk, uint32_t& row) {
+    if (archetype.chunks.empty() || archetype.chunks.back().count == archetype.capacity) {
+        archetype.chunks.emplace_back();
+        archetype.chunks.back().data.reset(new unsigned char[archetype.chunkBytes]);
+    }
+    chunk = static_cast<uint32_t>(archetype.chunks.size() - 1);
+    row = static_cast<uint32_t>(archetype.chunks.back().count++);
+    archetype.entityCount++;
+}
+
+void EntityWorld::removeRow(Archetype& archetype, uint32_t chunk, uint32_t row) {
+    Chunk& last = archetype.chunks.back();
+    uint32_t lastChunk = static_cast<uint32_t>(archetype.chunks.size() - 1);
+    uint32_t lastRow = static_cast<uint32_t>(last.count - 1);
+
+    if (chunk != lastChunk || row != lastRow) {
+        Chunk& hole = archetype.chunks[chunk];
+        Entity moved = archetype.entities(last)[lastRow];
+        archetype.entities(hole)[row] = moved;
+        for (size_t column = 0; column < archetype.components.size(); column++) {
+            const ComponentInfo& info = ComponentRegistry::get(archetype.components[column]);
+            void* from = archetype.component(last, static_cast<int>(column), lastRow);
+            info.moveConstruct(archetype.component(hole, static_cast<int>(column), row), from);
+            info.destroy(from);
+        }
+        Location& location = *entities.get(moved);
+        location.chunk = chunk;
+        location.row = row;
+    }
+
+    last.count--;
+    archetype.entityCount--;
+    if (last.count == 0) archetype.chunks.pop_back();
+}
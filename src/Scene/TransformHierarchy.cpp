@@ -0,0 +1,268 @@
+#include "../../include/Scene/TransformHierarchy.h"
+#include <algorithm>
+#include <cmath>
+
+int TransformHierarchy::createNode(int nodeUserData, const glm::vec3& position, const glm::vec3& rotation,
+                                   const glm::vec3& scale, int parent) {
+    int node;
+    if (!freeNodes.empty()) {
+        node = freeNodes.back();
+        freeNodes.pop_back();
+    } else {
+        node = static_cast<int>(indexOfNode.size());
+        indexOfNode.push_back(-1);
+    }
+
+    // Last in the parent's subtree; a new root goes to the end
+    size_t index = nodeAt.size();
+    if (parent != NullNode) {
+        size_t parentIndex = static_cast<size_t>(indexOfNode[parent]);
+        index = parentIndex + static_cast<size_t>(subtreeSizes[parentIndex]);
+    }
+    insertAt(index, node, nodeUserData, position, rotation, scale, parent);
+    addToAncestors(parent, 1);
+    return node;
+}
+
+void TransformHierarchy::destroyNode(int node) {
+    size_t index = static_cast<size_t>(indexOfNode[node]);
+    int parent = parentNodes[index];
+    size_t end = index + static_cast<size_t>(subtreeSizes[index]);
+
+    // The subtree stays in place: without the node it is still inside the parent's range
+    for (size_t child = index + 1; child < end; child += static_cast<size_t>(subtreeSizes[child])) {
+        parentNodes[child] = parent;
+        dirty[child] = 1;
+    }
+    anyDirty = true;
+
+    addToAncestors(parent, -1);
+    eraseAt(index);
+    indexOfNode[node] = -1;
+    freeNodes.push_back(node);
+}
+
+void TransformHierarchy::clear() {
+    positions.clear();
+    rotations.clear();
+    scales.clear();
+    worldMatrices.clear();
+    displacements.clear();
+    parentNodes.clear();
+    subtreeSizes.clear();
+    nodeAt.clear();
+    userData.clear();
+    dirty.clear();
+    indexOfNode.clear();
+    freeNodes.clear();
+    parentIndices.clear();
+    changedNodes.clear();
+    structureChanged = false;
+    anyDirty = false;
+}
+
+bool TransformHierarchy::setParent(int node, int parent) {
+    if (parent == node || (parent != NullNode && isDescendant(parent, node))) return false;
+
+    size_t index = static_cast<size_t>(indexOfNode[node]);
+    if (parentNodes[index] == parent) return true;
+
+    size_t count = static_cast<size_t>(subtreeSizes[index]);
+    size_t total = nodeAt.size();
+
+    // Move the subtree to the end, which leaves the rest a valid ordering, then in front
+    // of wherever the new parent's subtree ends
+    addToAncestors(parentNodes[index], -static_cast<int>(count));
+    rotateRange(index, index + count, total);
+
+    size_t target = total - count;
+    if (parent != NullNode) {
+        size_t parentIndex = static_cast<size_t>(indexOfNode[parent]);
+        target = parentIndex + static_cast<size_t>(subtreeSizes[parentIndex]);
+    }
+    rotateRange(target, total - count, total);
+
+    parentNodes[target] = parent;
+    dirty[target] = 1;
+    anyDirty = true;
+    structureChanged = true;
+    addToAncestors(parent, static_cast<int>(count));
+    return true;
+}
+
+bool TransformHierarchy::isDescendant(int node, int ancestor) const {
+    int index = indexOfNode[node];
+    int ancestorIndex = indexOfNode[ancestor];
+    return index > ancestorIndex && index < ancestorIndex + subtreeSizes[ancestorIndex];
+}
+
+void TransformHierarchy::setLocal(int node, const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale) {
+    size_t index = static_cast<size_t>(indexOfNode[node]);
+    positions[index] = position;
+    rotations[index] = rotation;
+    scales[index] = scale;
+    dirty[index] = 1;
+    anyDirty = true;
+}
+
+glm::mat4 TransformHierarchy::getParentWorldMatrix(int node) const {
+    int parent = parentNodes[indexOfNode[node]];
+    return parent == NullNode ? glm::mat4(1.0f) : worldMatrices[indexOfNode[parent]];
+}
+
+void TransformHierarchy::update(JobSystem* jobs) {
+    changedNodes.clear();
+    if (!anyDirty) return;
+
+    size_t count = nodeAt.size();
+    if (structureChanged) {
+        parentIndices.resize(count);
+        for (size_t i = 0; i < count; i++) {
+            parentIndices[i] = parentNodes[i] == NullNode ? -1 : indexOfNode[parentNodes[i]];
+        }
+        structureChanged = false;
+    }
+
+    size_t workerCount = !jobs || count < static_cast<size_t>(ParallelThreshold) ? 1 : jobs->getWorkerCount() + 1;
+
+    if (workerCount == 1) {
+        updateRange(0, count, changedNodes);
+    } else {
+        // Ranges of about count / workerCount nodes, each made of whole root subtrees so
+        // no worker reads a matrix another one is writing
+        std::vector<size_t> bounds(1, 0);
+        size_t end = 0;
+        for (size_t w = 1; w <= workerCount && end < count; w++) {
+            size_t target = count * w / workerCount;
+            while (end < target) end += static_cast<size_t>(subtreeSizes[end]);
+            bounds.push_back(end);
+        }
+
+        size_t rangeCount = bounds.size() - 1;
+        rangeChangedNodes.resize(rangeCount);
+        jobs->parallelFor(rangeCount, 1, [this, &bounds](size_t first, size_t last) {
+            for (size_t r = first; r < last; r++) updateRange(bounds[r], bounds[r + 1], rangeChangedNodes[r]);
+        });
+
+        for (size_t r = 0; r < rangeCount; r++) {
+            changedNodes.insert(changedNodes.end(), rangeChangedNodes[r].begin(), rangeChangedNodes[r].end());
+        }
+    }
+    anyDirty = false;
+}
+
+void TransformHierarchy::updateRange(size_t begin, size_t end, std::vector<int>& changed) {
+    changed.clear();
+    for (size_t i = begin; i < end; i++) {
+        int parent = parentIndices[i];
+        // A parent earlier in the range has already passed its flag on
+        if (!dirty[i] && (parent < 0 || !dirty[parent])) continue;
+        dirty[i] = 1;
+
+        glm::mat4 local = compose(positions[i], rotations[i], scales[i]);
+        glm::mat4 world = parent < 0 ? local : worldMatrices[parent] * local;
+        displacements[i] = glm::vec3(world[3]) - glm::vec3(worldMatrices[i][3]);
+        worldMatrices[i] = world;
+        changed.push_back(nodeAt[i]);
+    }
+    std::fill(dirty.begin() + begin, dirty.begin() + end, 0);
+}
+
+glm::mat4 TransformHierarchy::compose(const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale) {
+    glm::vec3 radians = glm::radians(rotation);
+    float sx = std::sin(radians.x), cx = std::cos(radians.x);
+    float sy = std::sin(radians.y), cy = std::cos(radians.y);
+    float sz = std::sin(radians.z), cz = std::cos(radians.z);
+
+    // Columns of rotateX * rotateY * rotateZ, each scaled
+    glm::mat4 m;
+    m[0] = glm::vec4(cy * cz, cx * sz + sx * sy * cz, sx * sz - cx * sy * cz, 0.0f) * scale.x;
+    m[1] = glm::vec4(-cy * sz, cx * cz - sx * sy * sz, sx * cz + cx * sy * sz, 0.0f) * scale.y;
+    m[2] = glm::vec4(sy, -sx * cy, cx * cy, 0.0f) * scale.z;
+    m[3] = glm::vec4(position, 1.0f);
+    return m;
+}
+
+void TransformHierarchy::decompose(const glm::mat4& matrix, glm::vec3& position, glm::vec3& rotation, glm::vec3& scale) {
+    position = glm::vec3(matrix[3]);
+
+    glm::vec3 axes[3] = { glm::vec3(matrix[0]), glm::vec3(matrix[1]), glm::vec3(matrix[2]) };
+    scale = glm::vec3(glm::length(axes[0]), glm::length(axes[1]), glm::length(axes[2]));
+    // A mirrored basis is stored as a negative x scale
+    if (glm::dot(glm::cross(axes[0], axes[1]), axes[2]) < 0.0f) scale.x = -scale.x;
+    for (int a = 0; a < 3; a++) {
+        if (scale[a] != 0.0f) axes[a] /= scale[a];
+    }
+
+    // axes[column][row] of rotateX * rotateY * rotateZ
+    float sy = glm::clamp(axes[2].x, -1.0f, 1.0f);
+    float x, y = std::asin(sy), z;
+    if (std::abs(sy) < 0.9999f) {
+        x = std::atan2(-axes[2].y, axes[2].z);
+        z = std::atan2(-axes[1].x, axes[0].x);
+    } else {
+        // Gimbal lock: only x + z or x - z is known, so put it all in x
+        x = std::atan2(axes[1].z, axes[1].y);
+        z = 0.0f;
+    }
+    rotation = glm::degrees(glm::vec3(x, y, z));
+}
+
+void TransformHierarchy::insertAt(size_t index, int node, int nodeUserData, const glm::vec3& position,
+                                  const glm::vec3& rotation, const glm::vec3& scale, int parent) {
+    positions.insert(positions.begin() + index, position);
+    rotations.insert(rotations.begin() + index, rotation);
+    scales.insert(scales.begin() + index, scale);
+    worldMatrices.insert(worldMatrices.begin() + index, glm::mat4(1.0f));
+    displacements.insert(displacements.begin() + index, glm::vec3(0.0f));
+    parentNodes.insert(parentNodes.begin() + index, parent);
+    subtreeSizes.insert(subtreeSizes.begin() + index, 1);
+    nodeAt.insert(nodeAt.begin() + index, node);
+    userData.insert(userData.begin() + index, nodeUserData);
+    dirty.insert(dirty.begin() + index, 1);
+    reindex(index, nodeAt.size());
+    anyDirty = true;
+}
+
+void TransformHierarchy::eraseAt(size_t index) {
+    positions.erase(positions.begin() + index);
+    rotations.erase(rotations.begin() + index);
+    scales.erase(scales.begin() + index);
+    worldMatrices.erase(worldMatrices.begin() + index);
+    displacements.erase(displacements.begin() + index);
+    parentNodes.erase(parentNodes.begin() + index);
+    subtreeSizes.erase(subtreeSizes.begin() + index);
+    nodeAt.erase(nodeAt.begin() + index);
+    userData.erase(userData.begin() + index);
+    dirty.erase(dirty.begin() + index);
+    reindex(index, nodeAt.size());
+}
+
+// Moves [middle, last) in front of [first, middle) in every array
+void TransformHierarchy::rotateRange(size_t first, size_t middle, size_t last) {
+    if (first == middle || middle == last) return;
+    std::rotate(positions.begin() + first, positions.begin() + middle, positions.begin() + last);
+    std::rotate(rotations.begin() + first, rotations.begin() + middle, rotations.begin() + last);
+    std::rotate(scales.begin() + first, scales.begin() + middle, scales.begin() + last);
+    std::rotate(worldMatrices.begin() + first, worldMatrices.begin() + middle, worldMatrices.begin() + last);
+    std::rotate(displacements.begin() + first, displacements.begin() + middle, displacements.begin() + last);
+    std::rotate(parentNodes.begin() + first, parentNodes.begin() + middle, parentNodes.begin() + last);
+    std::rotate(subtreeSizes.begin() + first, subtreeSizes.begin() + middle, subtreeSizes.begin() + last);
+    std::rotate(nodeAt.begin() + first, nodeAt.begin() + middle, nodeAt.begin() + last);
+    std::rotate(userData.begin() + first, userData.begin() + middle, userData.begin() + last);
+    std::rotate(dirty.begin() + first, dirty.begin() + middle, dirty.begin() + last);
+    reindex(first, last);
+}
+
+void TransformHierarchy::reindex(size_t first, size_t last) {
+    for (size_t i = first; i < last; i++) {
+        indexOfNode[nodeAt[i]] = static_cast<int>(i);
+    }
+    structureChanged = true;
+}
+
+void TransformHierarchy::addToAncestors(int parent, int count) {
+    for (int node = parent; node != NullNode; node = parentNodes[indexOfNode[node]]) {
+        subtreeSizes[indexOfNode[node]] += count;
+    }
+}
@@ -13,6 +13,7 @@ Shader::Shader(const char* vertexPath, const char* fragmentPath)
     std::string fragmentCode = readShaderFile(fragmentPath);
     
     compileShaders(vertexCode.c_str(), fragmentCode.c_str());
+    reflectUniforms();
 }
 
 std::string Shader::readShaderFile(const char* filePath)
@@ -57,6 +58,49 @@ void Shader::compileShaders(const char* vertexSource, const char* fragmentSource
     glDeleteShader(fragment);
 }
 
+void Shader::reflectUniforms()
+{
+    uniformLocations.clear();
+
+    GLint count = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+
+    char name[256];
+    for (GLint i = 0; i < count; i++)
+    {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(ID, (GLuint)i, sizeof(name), &length, &size, &type, name);
+
+        // Members of uniform blocks have no location
+        GLint location = glGetUniformLocation(ID, name);
+        if (location < 0)
+            continue;
+
+        std::string uniformName(name, length);
+        uniformLocations[uniformName] = location;
+
+        // Arrays are reported as "name[0]", register the bare name as well
+        size_t bracket = uniformName.find('[');
+        if (bracket != std::string::npos)
+            uniformLocations[uniformName.substr(0, bracket)] = location;
+    }
+}
+
+int Shader::getUniformLocation(const std::string &name) const
+{
+    auto it = uniformLocations.find(name);
+    return it != uniformLocations.end() ? it->second : -1;
+}
+
+void Shader::bindUniformBlock(const char* blockName, unsigned int bindingPoint) const
+{
+    GLuint blockIndex = glGetUniformBlockIndex(ID, blockName);
+    if (blockIndex != GL_INVALID_INDEX)
+        glUniformBlockBinding(ID, blockIndex, bindingPoint);
+}
+
 void Shader::use()
 {
     glUseProgram(ID);
@@ -89,25 +133,55 @@ void Shader::checkCompileErrors(unsigned int shader, std::string type)
 
 void Shader::setBool(const std::string &name, bool value) const
 {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+    glUniform1i(getUniformLocation(name), (int)value);
 }
 
 void Shader::setInt(const std::string &name, int value) const
 {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+    glUniform1i(getUniformLocation(name), value);
 }
 
 void Shader::setFloat(const std::string &name, float value) const
 {
-    glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+    glUniform1f(getUniformLocation(name), value);
 }
 
 void Shader::setVec3(const std::string &name, const glm::vec3 &value) const
 {
-    glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+    glUniform3fv(getUniformLocation(name), 1, &value[0]);
 }
 
 void Shader::setMat4(const std::string &name, const glm::mat4 &mat) const
 {
-    glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat));
+    glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, glm::value_ptr(mat));
+}
+
+void Shader::setInt(int location, int value) const
+{
+    glUniform1i(location, value);
+}
+
+void Shader::setFloat(int location, float value) const
+{
+    glUniform1f(location, value);
+}
+
+void Shader::setVec2(int location, const glm::vec2 &value) const
+{
+    glUniform2fv(location, 1, &value[0]);
+}
+
+void Shader::setVec3(int location, const glm::vec3 &value) const
+{
+    glUniform3fv(location, 1, &value[0]);
+}
+
+void Shader::setVec4(int location, const glm::vec4 &value) const
+{
+    glUniform4fv(location, 1, &value[0]);
+}
+
+void Shader::setMat4(int location, const glm::mat4 &mat) const
+{
+    glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(mat));
 }
\ No newline at end of file
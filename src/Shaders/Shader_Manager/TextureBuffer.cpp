@@ -0,0 +1,42 @@
+#include "../../../include/Shaders/TextureBuffer.h"
+#include "../../../include/Rendering/GLStateCache.h"
+#include <glad/glad.h>
+
+// Bound when the buffer has no data yet, so texelFetch never reads a zero-sized store
+static const size_t MinTextureBufferSize = 16;
+
+TextureBuffer::TextureBuffer(unsigned int internalFormat)
+{
+    capacity = MinTextureBufferSize;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+    glBufferData(GL_TEXTURE_BUFFER, capacity, nullptr, GL_STREAM_DRAW);
+
+    // The texture refers to the buffer object, so it survives the storage being replaced
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_BUFFER, texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, internalFormat, buffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+TextureBuffer::~TextureBuffer()
+{
+    if (texture) glDeleteTextures(1, &texture);
+    if (buffer) glDeleteBuffers(1, &buffer);
+}
+
+void TextureBuffer::update(const void* data, size_t size)
+{
+    if (size > capacity) capacity = size + size / 2;
+
+    glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+    glBufferData(GL_TEXTURE_BUFFER, capacity, nullptr, GL_STREAM_DRAW);
+    if (size > 0) glBufferSubData(GL_TEXTURE_BUFFER, 0, size, data);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void TextureBuffer::bind(GLStateCache& state, unsigned int unit) const
+{
+    state.bindTexture(unit, GL_TEXTURE_BUFFER, texture);
+}
@@ -0,0 +1,30 @@
+#include "../../../include/Shaders/UniformBuffer.h"
+#include <glad/glad.h>
+
+UniformBuffer::UniformBuffer(size_t size, unsigned int bindingPoint)
+    : size(size), binding(bindingPoint)
+{
+    glGenBuffers(1, &ID);
+    glBindBuffer(GL_UNIFORM_BUFFER, ID);
+    glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    glBindBufferBase(GL_UNIFORM_BUFFER, binding, ID);
+}
+
+UniformBuffer::~UniformBuffer()
+{
+    if (ID) {
+        glDeleteBuffers(1, &ID);
+        ID = 0;
+    }
+}
+
+void UniformBuffer::update(const void* data, size_t dataSize, size_t offset)
+{
+    if (offset + dataSize > size) return;
+
+    glBindBuffer(GL_UNIFORM_BUFFER, ID);
+    glBufferSubData(GL_UNIFORM_BUFFER, offset, dataSize, data);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
@@ -1,9 +1,12 @@
 #include "../../include/Skybox/Skybox.h"
 #include "../../include/Shaders/Shader.h"
+#include "../../include/Shaders/UniformBuffer.h"
+#include "../../include/Rendering/GLStateCache.h"
+#include "../ThirdParty/glm/gtc/matrix_transform.hpp"
 #include <glad/glad.h>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
-#include "../../src/ThirdParty/glm/glm.hpp"
-#include "../../src/ThirdParty/glm/gtc/type_ptr.hpp"
 
 // Skybox cube vertices (positions only, no normals/UVs needed)
 float skyboxVertices[] = {
@@ -51,15 +54,44 @@ float skyboxVertices[] = {
      1.0f, -1.0f,  1.0f
 };
 
+// Capture orientation for each face, in GL_TEXTURE_CUBE_MAP_POSITIVE_X + i order
+static const glm::vec3 faceDirections[6] = {
+    { 1.0f,  0.0f,  0.0f }, { -1.0f,  0.0f,  0.0f },
+    { 0.0f,  1.0f,  0.0f }, {  0.0f, -1.0f,  0.0f },
+    { 0.0f,  0.0f,  1.0f }, {  0.0f,  0.0f, -1.0f }
+};
+static const glm::vec3 faceUps[6] = {
+    { 0.0f, -1.0f,  0.0f }, {  0.0f, -1.0f,  0.0f },
+    { 0.0f,  0.0f,  1.0f }, {  0.0f,  0.0f, -1.0f },
+    { 0.0f, -1.0f,  0.0f }, {  0.0f, -1.0f,  0.0f }
+};
+
 Skybox::Skybox() {
     skyboxShader = new Shader("Resources/Shaders/skybox_vert.glsl", "Resources/Shaders/skybox_frag.glsl");
+    skyboxShader->bindUniformBlock("FrameData", FRAME_UNIFORM_BINDING);
+    skyboxShader->use();
+    skyboxShader->setInt(skyboxShader->getUniformLocation("skyMap"), 0);
+
+    bakeShader = new Shader("Resources/Shaders/skybox_bake_vert.glsl", "Resources/Shaders/skybox_bake_frag.glsl");
+    timeOfDayLocation = bakeShader->getUniformLocation("timeOfDay");
+    faceViewProjectionLocation = bakeShader->getUniformLocation("faceViewProjection");
+
     setupMesh();
+
+    glGenFramebuffers(1, &bakeFramebuffer);
+    cubemap = createCubemap(BakeResolution);
+    // Filter across face edges so the seams of the baked sky don't show
+    glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
 }
 
 Skybox::~Skybox() {
     delete skyboxShader;
+    delete bakeShader;
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
+    glDeleteFramebuffers(1, &bakeFramebuffer);
+    glDeleteTextures(1, &cubemap);
+    if (previewCubemap) glDeleteTextures(1, &previewCubemap);
 }
 
 void Skybox::setupMesh() {
@@ -76,26 +108,129 @@ void Skybox::setupMesh() {
     glBindVertexArray(0);
 }
 
-void Skybox::setTimeOfDay(float time) {
+unsigned int Skybox::createCubemap(int resolution) {
+    unsigned int texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, texture);
+    // Packed float keeps the sun glow above 1.0 at the size of an 8-bit target
+    for (int face = 0; face < 6; face++) {
+        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, GL_R11F_G11F_B10F, resolution, resolution, 0, GL_RGB, GL_FLOAT, NULL);
+    }
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, 0);
+    return texture;
+}
+
+void Skybox::bakeFaces(GLStateCache& state, unsigned int target, int resolution) {
+    // The bake target has no depth attachment, so every face pixel passes the depth test
+    state.bindFramebuffer(bakeFramebuffer);
+    glViewport(0, 0, resolution, resolution);
+    state.useProgram(bakeShader->ID);
+    state.bindVertexArray(VAO);
+    bakeShader->setFloat(timeOfDayLocation, timeOfDay);
+
+    glm::mat4 projection = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 10.0f);
+    for (int face = 0; face < 6; face++) {
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, target, 0);
+        glm::mat4 view = glm::lookAt(glm::vec3(0.0f), faceDirections[face], faceUps[face]);
+        bakeShader->setMat4(faceViewProjectionLocation, projection * view);
+        glDrawArrays(GL_TRIANGLES, 0, 36);
+    }
+    bakeCount++;
+}
+
+bool Skybox::updateBake(GLStateCache& state) {
+    // A finished edit leaves the preview on screen until the full bake replaces it
+    bool previewStale = showingPreview && !editing;
+    if (!dirty && !previewStale) return false;
+
+    if (editing) {
+        if (!previewCubemap) {
+            previewCubemap = createCubemap(PreviewResolution);
+            state.invalidate(); // createCubemap binds behind the cache
+        }
+        bakeFaces(state, previewCubemap, PreviewResolution);
+        showingPreview = true;
+    } else {
+        bakeFaces(state, cubemap, BakeResolution);
+        showingPreview = false;
+    }
+    dirty = false;
+    return true;
+}
+
+void Skybox::setTimeOfDay(float time, bool interactive) {
+    if (time != timeOfDay) dirty = true;
     timeOfDay = time;
+    editing = interactive && previewWhileEditing;
 }
 
-void Skybox::draw(const float* view, const float* projection) {
-    // Properly reconstruct the view matrix from the float array
-    glm::mat4 viewMat = glm::make_mat4(view);
-    glm::mat4 projMat = glm::make_mat4(projection);
+void Skybox::draw(GLStateCache& state) {
+    state.useProgram(skyboxShader->ID);
+    state.bindTexture(0, GL_TEXTURE_CUBE_MAP, showingPreview ? previewCubemap : cubemap);
     
-    // Remove translation from view matrix (keep only rotation)
-    viewMat = glm::mat4(glm::mat3(viewMat));
-    
-    glDepthFunc(GL_LEQUAL);
-    skyboxShader->use();
-    skyboxShader->setMat4("view", viewMat);
-    skyboxShader->setMat4("projection", projMat);
-    skyboxShader->setFloat("timeOfDay", timeOfDay);
-    
-    glBindVertexArray(VAO);
+    state.bindVertexArray(VAO);
     glDrawArrays(GL_TRIANGLES, 0, 36);
-    glBindVertexArray(0);
-    glDepthFunc(GL_LESS);
-}
\ No newline at end of file
+}
+
+glm::vec3 Skybox::getSunDirection(float tod) {
+    float angle = glm::fract(tod) * 6.28318530718f;
+    return glm::normalize(glm::vec3(std::cos(angle), std::sin(angle) * 0.5f, std::sin(angle)));
+}
+
+glm::vec3 Skybox::getSunColor(float tod) {
+    float sunVisibility = glm::smoothstep(-0.12f, 0.15f, getSunDirection(tod).y);
+    return glm::vec3(1.0f, 0.95f, 0.8f) * sunVisibility;
+}
+
+glm::vec3 Skybox::evaluateSky(const glm::vec3& dir, float tod) {
+    // Keep in step with getSkyColor() in skybox_bake_frag.glsl
+    float height = dir.y;
+
+    float t = glm::fract(tod);
+    glm::vec3 sunDir = getSunDirection(tod);
+    float sunDot = std::max(glm::dot(dir, sunDir), 0.0f);
+
+    const glm::vec3 nightTop(0.01f, 0.01f, 0.05f);
+    const glm::vec3 nightHorizon(0.05f, 0.05f, 0.15f);
+    const glm::vec3 dayTop(0.3f, 0.5f, 0.9f);
+    const glm::vec3 dayHorizon(0.6f, 0.7f, 0.9f);
+    const glm::vec3 sunriseTop(0.4f, 0.3f, 0.5f);
+    const glm::vec3 sunriseHorizon(1.0f, 0.5f, 0.3f);
+    const glm::vec3 sunsetTop(0.5f, 0.3f, 0.4f);
+    const glm::vec3 sunsetHorizon(1.0f, 0.4f, 0.2f);
+
+    glm::vec3 skyTop, skyHorizon;
+    if (t < 0.25f) {
+        float f = t * 4.0f;
+        skyTop = glm::mix(nightTop, sunriseTop, f);
+        skyHorizon = glm::mix(nightHorizon, sunriseHorizon, f);
+    } else if (t < 0.5f) {
+        float f = (t - 0.25f) * 4.0f;
+        skyTop = glm::mix(sunriseTop, dayTop, f);
+        skyHorizon = glm::mix(sunriseHorizon, dayHorizon, f);
+    } else if (t < 0.75f) {
+        float f = (t - 0.5f) * 4.0f;
+        skyTop = glm::mix(dayTop, sunsetTop, f);
+        skyHorizon = glm::mix(dayHorizon, sunsetHorizon, f);
+    } else {
+        float f = (t - 0.75f) * 4.0f;
+        skyTop = glm::mix(sunsetTop, nightTop, f);
+        skyHorizon = glm::mix(sunsetHorizon, nightHorizon, f);
+    }
+
+    glm::vec3 skyColor = glm::mix(skyHorizon, skyTop, glm::smoothstep(-0.3f, 0.3f, height));
+
+    const glm::vec3 sunCol(1.0f, 0.95f, 0.8f);
+    float sunGlow = std::pow(sunDot, 128.0f) * 2.0f;
+    float sunDisc = glm::smoothstep(0.9995f, 0.9998f, sunDot);
+    float atmGlow = std::pow(sunDot, 8.0f) * 0.5f;
+
+    float sunVisibility = glm::smoothstep(-0.12f, 0.15f, sunDir.y);
+    skyColor += sunCol * (sunDisc + atmGlow + sunGlow * 0.3f) * sunVisibility;
+    return skyColor;
+}
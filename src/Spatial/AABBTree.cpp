@@ -0,0 +1,419 @@
+#include "../../include/Spatial/AABBTree.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+AABB combine(const AABB& a, const AABB& b) {
+    AABB result;
+    result.min = glm::min(a.min, b.min);
+    result.max = glm::max(a.max, b.max);
+    return result;
+}
+
+bool contains(const AABB& outer, const AABB& inner) {
+    return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y && outer.min.z <= inner.min.z &&
+           outer.max.x >= inner.max.x && outer.max.y >= inner.max.y && outer.max.z >= inner.max.z;
+}
+
+bool overlaps(const AABB& a, const AABB& b) {
+    return a.min.x <= b.max.x && a.max.x >= b.min.x &&
+           a.min.y <= b.max.y && a.max.y >= b.min.y &&
+           a.min.z <= b.max.z && a.max.z >= b.min.z;
+}
+
+float surfaceArea(const AABB& box) {
+    glm::vec3 d = box.max - box.min;
+    return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
+enum class FrustumTest { Outside, Intersects, Inside };
+
+FrustumTest classify(const Frustum& frustum, const AABB& box) {
+    FrustumTest result = FrustumTest::Inside;
+    for (const glm::vec4& plane : frustum.planes) {
+        glm::vec3 positive(plane.x >= 0.0f ? box.max.x : box.min.x,
+                           plane.y >= 0.0f ? box.max.y : box.min.y,
+                           plane.z >= 0.0f ? box.max.z : box.min.z);
+        if (glm::dot(glm::vec3(plane), positive) + plane.w < 0.0f) return FrustumTest::Outside;
+
+        glm::vec3 negative(plane.x >= 0.0f ? box.min.x : box.max.x,
+                           plane.y >= 0.0f ? box.min.y : box.max.y,
+                           plane.z >= 0.0f ? box.min.z : box.max.z);
+        if (glm::dot(glm::vec3(plane), negative) + plane.w < 0.0f) result = FrustumTest::Intersects;
+    }
+    return result;
+}
+
+} // namespace
+
+AABBTree::AABBTree(float margin) : margin(margin) {}
+
+int AABBTree::allocateNode() {
+    if (freeList == NullNode) {
+        nodes.emplace_back();
+        return static_cast<int>(nodes.size() - 1);
+    }
+
+    int nodeId = freeList;
+    freeList = nodes[nodeId].parent;
+    nodes[nodeId] = Node();
+    return nodeId;
+}
+
+void AABBTree::freeNode(int nodeId) {
+    nodes[nodeId].parent = freeList;
+    nodes[nodeId].height = -1;
+    freeList = nodeId;
+}
+
+void AABBTree::clear() {
+    nodes.clear();
+    root = NullNode;
+    freeList = NullNode;
+    proxyCount = 0;
+}
+
+int AABBTree::createProxy(const AABB& box, int userData) {
+    int proxyId = allocateNode();
+    Node& node = nodes[proxyId];
+    node.box.min = box.min - glm::vec3(margin);
+    node.box.max = box.max + glm::vec3(margin);
+    node.userData = userData;
+    node.height = 0;
+
+    insertLeaf(proxyId);
+    proxyCount++;
+    return proxyId;
+}
+
+void AABBTree::destroyProxy(int proxyId) {
+    if (proxyId < 0 || proxyId >= static_cast<int>(nodes.size()) || !nodes[proxyId].isLeaf()) return;
+
+    removeLeaf(proxyId);
+    freeNode(proxyId);
+    proxyCount--;
+}
+
+bool AABBTree::moveProxy(int proxyId, const AABB& box, const glm::vec3& displacement) {
+    if (contains(nodes[proxyId].box, box)) return false;
+
+    removeLeaf(proxyId);
+
+    // Fatten, then stretch along the motion so a steady drag doesn't reinsert every frame
+    AABB fat;
+    fat.min = box.min - glm::vec3(margin);
+    fat.max = box.max + glm::vec3(margin);
+    glm::vec3 predicted = displacement * 2.0f;
+    fat.min += glm::min(predicted, glm::vec3(0.0f));
+    fat.max += glm::max(predicted, glm::vec3(0.0f));
+    nodes[proxyId].box = fat;
+
+    insertLeaf(proxyId);
+    return true;
+}
+
+void AABBTree::insertLeaf(int leaf) {
+    if (root == NullNode) {
+        root = leaf;
+        nodes[root].parent = NullNode;
+        return;
+    }
+
+    // Walk down towards the sibling with the lowest surface-area cost
+    const AABB leafBox = nodes[leaf].box;
+    int index = root;
+    while (!nodes[index].isLeaf()) {
+        const Node& node = nodes[index];
+        int child1 = node.child1;
+        int child2 = node.child2;
+
+        float area = surfaceArea(node.box);
+        float combinedArea = surfaceArea(combine(node.box, leafBox));
+
+        // Cost of making a new parent for this node and the leaf
+        float cost = 2.0f * combinedArea;
+        // Minimum cost of pushing the leaf further down the tree
+        float inheritanceCost = 2.0f * (combinedArea - area);
+
+        auto descendCost = [&](int child) {
+            float newArea = surfaceArea(combine(leafBox, nodes[child].box));
+            if (nodes[child].isLeaf()) return newArea + inheritanceCost;
+            return (newArea - surfaceArea(nodes[child].box)) + inheritanceCost;
+        };
+        float cost1 = descendCost(child1);
+        float cost2 = descendCost(child2);
+
+        if (cost < cost1 && cost < cost2) break;
+        index = cost1 < cost2 ? child1 : child2;
+    }
+
+    int sibling = index;
+    int oldParent = nodes[sibling].parent;
+    int newParent = allocateNode();
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].box = combine(leafBox, nodes[sibling].box);
+    nodes[newParent].height = nodes[sibling].height + 1;
+    nodes[newParent].child1 = sibling;
+    nodes[newParent].child2 = leaf;
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+
+    if (oldParent != NullNode) {
+        if (nodes[oldParent].child1 == sibling) nodes[oldParent].child1 = newParent;
+        else nodes[oldParent].child2 = newParent;
+    } else {
+        root = newParent;
+    }
+
+    refitUpwards(nodes[leaf].parent);
+}
+
+void AABBTree::removeLeaf(int leaf) {
+    if (leaf == root) {
+        root = NullNode;
+        return;
+    }
+
+    int parent = nodes[leaf].parent;
+    int grandParent = nodes[parent].parent;
+    int sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+    if (grandParent != NullNode) {
+        if (nodes[grandParent].child1 == parent) nodes[grandParent].child1 = sibling;
+        else nodes[grandParent].child2 = sibling;
+        nodes[sibling].parent = grandParent;
+        freeNode(parent);
+        refitUpwards(grandParent);
+    } else {
+        root = sibling;
+        nodes[sibling].parent = NullNode;
+        freeNode(parent);
+    }
+}
+
+void AABBTree::refitUpwards(int nodeId) {
+    int index = nodeId;
+    while (index != NullNode) {
+        index = balance(index);
+
+        Node& node = nodes[index];
+        node.height = 1 + std::max(nodes[node.child1].height, nodes[node.child2].height);
+        node.box = combine(nodes[node.child1].box, nodes[node.child2].box);
+
+        index = node.parent;
+    }
+}
+
+// Performs a left or right rotation if node A is imbalanced; returns the new subtree root
+int AABBTree::balance(int iA) {
+    Node& A = nodes[iA];
+    if (A.isLeaf() || A.height < 2) return iA;
+
+    int iB = A.child1;
+    int iC = A.child2;
+    Node& B = nodes[iB];
+    Node& C = nodes[iC];
+
+    int balanceFactor = C.height - B.height;
+
+    // Rotate C up
+    if (balanceFactor > 1) {
+        int iF = C.child1;
+        int iG = C.child2;
+        Node& F = nodes[iF];
+        Node& G = nodes[iG];
+
+        C.child1 = iA;
+        C.parent = A.parent;
+        A.parent = iC;
+
+        if (C.parent != NullNode) {
+            if (nodes[C.parent].child1 == iA) nodes[C.parent].child1 = iC;
+            else nodes[C.parent].child2 = iC;
+        } else {
+            root = iC;
+        }
+
+        if (F.height > G.height) {
+            C.child2 = iF;
+            A.child2 = iG;
+            G.parent = iA;
+            A.box = combine(B.box, G.box);
+            C.box = combine(A.box, F.box);
+            A.height = 1 + std::max(B.height, G.height);
+            C.height = 1 + std::max(A.height, F.height);
+        } else {
+            C.child2 = iG;
+            A.child2 = iF;
+            F.parent = iA;
+            A.box = combine(B.box, F.box);
+            C.box = combine(A.box, G.box);
+            A.height = 1 + std::max(B.height, F.height);
+            C.height = 1 + std::max(A.height, G.height);
+        }
+        return iC;
+    }
+
+    // Rotate B up
+    if (balanceFactor < -1) {
+        int iD = B.child1;
+        int iE = B.child2;
+        Node& D = nodes[iD];
+        Node& E = nodes[iE];
+
+        B.child1 = iA;
+        B.parent = A.parent;
+        A.parent = iB;
+
+        if (B.parent != NullNode) {
+            if (nodes[B.parent].child1 == iA) nodes[B.parent].child1 = iB;
+            else nodes[B.parent].child2 = iB;
+        } else {
+            root = iB;
+        }
+
+        if (D.height > E.height) {
+            B.child2 = iD;
+            A.child1 = iE;
+            E.parent = iA;
+            A.box = combine(C.box, E.box);
+            B.box = combine(A.box, D.box);
+            A.height = 1 + std::max(C.height, E.height);
+            B.height = 1 + std::max(A.height, D.height);
+        } else {
+            B.child2 = iE;
+            A.child1 = iD;
+            D.parent = iA;
+            A.box = combine(C.box, D.box);
+            B.box = combine(A.box, E.box);
+            A.height = 1 + std::max(C.height, D.height);
+            B.height = 1 + std::max(A.height, E.height);
+        }
+        return iB;
+    }
+
+    return iA;
+}
+
+void AABBTree::collectLeaves(int nodeId, std::vector<int>& results, std::vector<int>& stack) const {
+    size_t base = stack.size();
+    stack.push_back(nodeId);
+    while (stack.size() > base) {
+        int index = stack.back();
+        stack.pop_back();
+
+        const Node& node = nodes[index];
+        if (node.isLeaf()) {
+            results.push_back(node.userData);
+        } else {
+            stack.push_back(node.child1);
+            stack.push_back(node.child2);
+        }
+    }
+}
+
+void AABBTree::queryFrustum(const Frustum& frustum, std::vector<int>& results) const {
+    if (root == NullNode) return;
+
+    std::vector<int> stack;
+    stack.reserve(64);
+    stack.push_back(root);
+    while (!stack.empty()) {
+        int index = stack.back();
+        stack.pop_back();
+
+        const Node& node = nodes[index];
+        FrustumTest test = classify(frustum, node.box);
+        if (test == FrustumTest::Outside) continue;
+
+        // Whole subtree is visible, no need to test its children
+        if (test == FrustumTest::Inside || node.isLeaf()) {
+            collectLeaves(index, results, stack);
+            continue;
+        }
+
+        stack.push_back(node.child1);
+        stack.push_back(node.child2);
+    }
+}
+
+void AABBTree::queryBox(const AABB& box, std::vector<int>& results) const {
+    if (root == NullNode) return;
+
+    std::vector<int> stack;
+    stack.reserve(64);
+    stack.push_back(root);
+    while (!stack.empty()) {
+        int index = stack.back();
+        stack.pop_back();
+
+        const Node& node = nodes[index];
+        if (!overlaps(node.box, box)) continue;
+
+        if (node.isLeaf()) {
+            results.push_back(node.userData);
+        } else {
+            stack.push_back(node.child1);
+            stack.push_back(node.child2);
+        }
+    }
+}
+
+void AABBTree::querySphere(const glm::vec3& center, float radius, std::vector<int>& results) const {
+    if (root == NullNode) return;
+
+    float radiusSq = radius * radius;
+    std::vector<int> stack;
+    stack.reserve(64);
+    stack.push_back(root);
+    while (!stack.empty()) {
+        int index = stack.back();
+        stack.pop_back();
+
+        const Node& node = nodes[index];
+        glm::vec3 closest = glm::clamp(center, node.box.min, node.box.max);
+        glm::vec3 delta = closest - center;
+        if (glm::dot(delta, delta) > radiusSq) continue;
+
+        if (node.isLeaf()) {
+            results.push_back(node.userData);
+        } else {
+            stack.push_back(node.child1);
+            stack.push_back(node.child2);
+        }
+    }
+}
+
+void AABBTree::queryRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, std::vector<RayHit>& results) const {
+    if (root == NullNode) return;
+
+    const float inf = std::numeric_limits<float>::infinity();
+    glm::vec3 invDir(direction.x != 0.0f ? 1.0f / direction.x : inf,
+                     direction.y != 0.0f ? 1.0f / direction.y : inf,
+                     direction.z != 0.0f ? 1.0f / direction.z : inf);
+
+    size_t first = results.size();
+    std::vector<int> stack;
+    stack.reserve(64);
+    stack.push_back(root);
+    while (!stack.empty()) {
+        int index = stack.back();
+        stack.pop_back();
+
+        const Node& node = nodes[index];
+        float entry = 0.0f;
+        if (!intersectRayAABB(origin, invDir, maxDistance, node.box, entry)) continue;
+
+        if (node.isLeaf()) {
+            results.push_back({ node.userData, entry });
+        } else {
+            stack.push_back(node.child1);
+            stack.push_back(node.child2);
+        }
+    }
+
+    std::sort(results.begin() + first, results.end(),
+        [](const RayHit& a, const RayHit& b) { return a.distance < b.distance; });
+}
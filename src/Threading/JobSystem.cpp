@@ -0,0 +1,274 @@
+#include "../../include/Threading/JobSystem.h"
+#include "../../include/Profiling/CpuProfiler.h"
+#include <algorithm>
+
+struct Job {
+    JobSystem::Task task;
+    bool mainThread = false;
+    // One extra until submit() has registered every dependency
+    std::atomic<int> pendingDependencies{ 1 };
+    std::atomic<bool> done{ false };
+
+    std::mutex mutex;
+    bool finished = false;                       // guards dependents; set before done
+    std::vector<std::shared_ptr<Job>> dependents;
+};
+
+namespace {
+
+// Lets a worker find its own deque; null on threads outside any pool
+thread_local const JobSystem* currentPool = nullptr;
+thread_local size_t currentWorker = 0;
+
+} // namespace
+
+bool JobHandle::isDone() const {
+    return !job || job->done.load(std::memory_order_acquire);
+}
+
+JobSystem::JobSystem(unsigned int workerCount) : mainThreadId(std::this_thread::get_id()) {
+    start(workerCount);
+}
+
+JobSystem::~JobSystem() {
+    stop();
+}
+
+void JobSystem::setWorkerCount(unsigned int workerCount) {
+    workerCount = resolveWorkerCount(workerCount);
+    if (workerCount == workers.size()) return;
+    stop();
+    start(workerCount);
+}
+
+unsigned int JobSystem::resolveWorkerCount(unsigned int workerCount) {
+    if (workerCount > 0) return workerCount;
+    unsigned int hardwareThreads = std::thread::hardware_concurrency();
+    return hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+}
+
+void JobSystem::start(unsigned int workerCount) {
+    workerCount = resolveWorkerCount(workerCount);
+    for (unsigned int i = 0; i < workerCount; i++) queues.push_back(std::unique_ptr<WorkerQueue>(new WorkerQueue()));
+    workers.reserve(workerCount);
+    for (unsigned int i = 0; i < workerCount; i++) workers.emplace_back(&JobSystem::workerLoop, this, static_cast<size_t>(i));
+}
+
+void JobSystem::stop() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    for (std::thread& worker : workers) worker.join();
+    workers.clear();
+    queues.clear();
+    stopping = false;
+}
+
+void JobSystem::workerLoop(size_t index) {
+    currentPool = this;
+    currentWorker = index;
+    PROFILE_THREAD_NAME("Job worker");
+
+    while (true) {
+        if (runOneJob()) continue;
+
+        // Queued work is drained before stopping
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleepingWorkers.fetch_add(1);
+        workAvailable.wait(lock, [this]() { return stopping || queuedJobs.load() > 0; });
+        sleepingWorkers.fetch_sub(1);
+        if (stopping && queuedJobs.load() == 0) break;
+    }
+    currentPool = nullptr;
+}
+
+JobHandle JobSystem::schedule(Task task, const std::vector<JobHandle>& dependencies) {
+    return submit(std::move(task), false, dependencies);
+}
+
+JobHandle JobSystem::runOnMainThread(Task task, const std::vector<JobHandle>& dependencies) {
+    return submit(std::move(task), true, dependencies);
+}
+
+JobHandle JobSystem::submit(Task task, bool mainThread, const std::vector<JobHandle>& dependencies) {
+    std::shared_ptr<Job> job = std::make_shared<Job>();
+    job->task = std::move(task);
+    job->mainThread = mainThread;
+
+    for (const JobHandle& dependency : dependencies) {
+        if (!dependency.job) continue;
+        std::lock_guard<std::mutex> lock(dependency.job->mutex);
+        if (dependency.job->finished) continue;
+        dependency.job->dependents.push_back(job);
+        job->pendingDependencies.fetch_add(1);
+    }
+    release(job);
+
+    JobHandle handle;
+    handle.job = job;
+    return handle;
+}
+
+void JobSystem::release(const std::shared_ptr<Job>& job) {
+    if (job->pendingDependencies.fetch_sub(1) == 1) enqueue(job);
+}
+
+void JobSystem::enqueue(const std::shared_ptr<Job>& job) {
+    if (job->mainThread) {
+        {
+            std::lock_guard<std::mutex> lock(mainThreadMutex);
+            mainThreadJobs.push_back(job);
+        }
+        if (mainThreadWakeup) mainThreadWakeup();
+        notifyWaiters();
+        return;
+    }
+
+    // A worker keeps what it spawns; other threads spread their jobs over the deques.
+    // Counted before it is visible so a thief never takes the count below zero.
+    size_t queue = currentPool == this ? currentWorker : nextQueue.fetch_add(1) % queues.size();
+    queuedJobs.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(queues[queue]->mutex);
+        queues[queue]->jobs.push_back(job);
+    }
+
+    // A sleeper counts itself before checking queuedJobs, so either it sees the job or
+    // we see it
+    if (sleepingWorkers.load() > 0) {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        workAvailable.notify_one();
+    }
+    notifyWaiters();
+}
+
+void JobSystem::execute(const std::shared_ptr<Job>& job) {
+    job->task();
+    job->task = nullptr;  // drop captures now, the handle may live much longer
+
+    std::vector<std::shared_ptr<Job>> dependents;
+    {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        job->finished = true;
+        dependents.swap(job->dependents);
+    }
+    job->done.store(true);  // seq_cst, see notifyWaiters()
+
+    for (const std::shared_ptr<Job>& dependent : dependents) release(dependent);
+    notifyWaiters();
+}
+
+bool JobSystem::runOneJob() {
+    if (queuedJobs.load() == 0) return false;
+
+    std::shared_ptr<Job> job;
+    size_t queueCount = queues.size();
+    size_t first = nextQueue.load();
+    if (currentPool == this) {
+        // Newest first from our own deque: its data is most likely still in cache
+        WorkerQueue& own = *queues[currentWorker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.jobs.empty()) {
+            job = std::move(own.jobs.back());
+            own.jobs.pop_back();
+        }
+        first = currentWorker + 1;
+    }
+    // Oldest first from the others: usually the biggest piece of what's left
+    for (size_t i = 0; !job && i < queueCount; i++) {
+        WorkerQueue& victim = *queues[(first + i) % queueCount];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.jobs.empty()) {
+            job = std::move(victim.jobs.front());
+            victim.jobs.pop_front();
+        }
+    }
+    if (!job) return false;
+
+    queuedJobs.fetch_sub(1);
+    execute(job);
+    return true;
+}
+
+void JobSystem::notifyWaiters() {
+    // A waiter counts itself before checking done, queuedJobs and the main-thread queue,
+    // and we changed one of those before getting here. A plain load could be ordered
+    // before that change, so both sides miss each other and the waiter sleeps for good.
+    // As a read-modify-write this either reads the waiter's increment or is read by it,
+    // which then sees our change.
+    if (waitingThreads.fetch_add(0) == 0) return;
+    std::lock_guard<std::mutex> lock(sleepMutex);
+    jobDone.notify_all();
+}
+
+void JobSystem::wait(const JobHandle& handle) {
+    if (!handle.job) return;
+    const Job& job = *handle.job;
+    bool onMainThread = std::this_thread::get_id() == mainThreadId;
+
+    while (!job.done.load(std::memory_order_acquire)) {
+        if (runOneJob()) continue;
+        if (onMainThread && runMainThreadTasks() > 0) continue;
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        waitingThreads.fetch_add(1);
+        jobDone.wait(lock, [&]() {
+            return job.done.load() || queuedJobs.load() > 0 || (onMainThread && hasMainThreadTasks());
+        });
+        waitingThreads.fetch_sub(1);
+    }
+}
+
+void JobSystem::parallelFor(size_t count, size_t grainSize, const RangeFunction& fn) {
+    if (count == 0) return;
+    grainSize = std::max<size_t>(1, grainSize);
+    size_t rangeCount = (count + grainSize - 1) / grainSize;
+    if (rangeCount == 1) {
+        fn(0, count);
+        return;
+    }
+
+    // Ranges are claimed from a shared counter, so a helper that starts late finds none
+    // left and returns without touching fn, which may be gone by then
+    struct Progress {
+        std::atomic<size_t> next{ 0 };
+        std::atomic<size_t> completed{ 0 };
+    };
+    std::shared_ptr<Progress> progress = std::make_shared<Progress>();
+    const RangeFunction* body = &fn;
+    Task runRanges = [progress, body, count, grainSize, rangeCount]() {
+        for (size_t range = progress->next.fetch_add(1); range < rangeCount; range = progress->next.fetch_add(1)) {
+            size_t begin = range * grainSize;
+            (*body)(begin, std::min(begin + grainSize, count));
+            progress->completed.fetch_add(1, std::memory_order_release);
+        }
+    };
+
+    size_t helpers = std::min<size_t>(workers.size(), rangeCount - 1);
+    for (size_t i = 0; i < helpers; i++) submit(runRanges, false, {});
+    runRanges();
+
+    // Every range is claimed by now and running on some thread. Help with queued jobs
+    // meanwhile, as wait() does, so a range that waits on pool work can't starve it.
+    while (progress->completed.load(std::memory_order_acquire) < rangeCount) {
+        if (!runOneJob()) std::this_thread::yield();
+    }
+}
+
+size_t JobSystem::runMainThreadTasks() {
+    std::vector<std::shared_ptr<Job>> ready;
+    {
+        std::lock_guard<std::mutex> lock(mainThreadMutex);
+        ready.swap(mainThreadJobs);
+    }
+    // Main-thread jobs these release are queued for the next call
+    for (const std::shared_ptr<Job>& job : ready) execute(job);
+    return ready.size();
+}
+
+bool JobSystem::hasMainThreadTasks() const {
+    std::lock_guard<std::mutex> lock(mainThreadMutex);
+    return !mainThreadJobs.empty();
+}
@@ -22,6 +22,8 @@ GLFWwindow* Window::makeWindow() {
     }
 
     glfwMakeContextCurrent(window);
+    // Without vsync a continuously redrawing editor spins as fast as the GPU allows
+    glfwSwapInterval(1);
 
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
         std::cerr << "Failed to initialize GLAD\n";
@@ -1,5 +1,6 @@
 #include <iostream>
 #include <algorithm>
+#include <cassert>
 #include <stdexcept>
 #include <filesystem>
 #include <fstream>
@@ -8,6 +9,10 @@
 #include <chrono>
 #include <cmath>
 #include <cstdlib>
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <unordered_map>
 #include <glad/glad.h>
 #include "ThirdParty/imgui/imgui.h"
 #include "ThirdParty/imgui/imgui_internal.h"
@@ -20,8 +25,29 @@
 #include "../include/ThirdParty/tiny_obj_loader.h"
 #include "../include/Window/Window.h"
 #include "../include/Shaders/Shader.h"
+#include "../include/Shaders/UniformBuffer.h"
 #include "../include/Textures/Texture.h"
 #include "../include/Skybox/Skybox.h"
+#include "../include/Lighting/SphericalHarmonics.h"
+#include "../include/Lighting/LightClusters.h"
+#include "../include/Lighting/CascadedShadowMap.h"
+#include "../include/Shaders/TextureBuffer.h"
+#include "../include/Culling/Culling.h"
+#include "../include/Rendering/RenderQueue.h"
+#include "../include/Rendering/GLStateCache.h"
+#include "../include/Rendering/DynamicResolution.h"
+#include "../include/Rendering/RenderTargetPool.h"
+#include "../include/Rendering/GpuProfiler.h"
+#include "../include/Profiling/CpuProfiler.h"
+#include "../include/Rendering/TemporalUpsampler.h"
+#include "../include/Spatial/AABBTree.h"
+#include "../include/Scene/TransformHierarchy.h"
+#include "../include/Scene/EntityWorld.h"
+#include "../include/Scene/SceneComponents.h"
+#include "../include/Geometry/MeshOptimizer.h"
+#include "../include/Geometry/VertexFormat.h"
+#include "../include/Geometry/MeshSimplifier.h"
+#include "../include/Threading/JobSystem.h"
 
 #ifdef _WIN32
 #include <windows.h>
@@ -37,6 +63,18 @@ constexpr float NEAR_PLANE = 0.1f;
 constexpr float FAR_PLANE = 100.0f;
 constexpr float PI = 3.14159265359f;
 
+// Projected height (fraction of the viewport) at which a mesh gets full detail; coarser
+// levels take over below this scaled by sqrt of their triangle ratio
+constexpr float LOD_FULL_DETAIL_SCREEN_SIZE = 0.5f;
+// Relative margin around each LOD switch so objects near a threshold don't pop back and forth
+constexpr float LOD_HYSTERESIS = 0.15f;
+
+// Objects per job when the per-object render preparation is split across the job workers
+constexpr size_t RENDER_PREP_GRAIN = 256;
+
+// View depth covered by the sun's shadow cascades
+constexpr float SHADOW_DISTANCE = 60.0f;
+
 // Replace the existing float vertices[] array (lines ~50-100) with this full 8-float version (pos + normal + texcoord)
 float vertices[] = {
     // Back face (z = -0.5f)
@@ -88,13 +126,6 @@ float vertices[] = {
     -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 1.0f
 };
 
-enum class ObjectType {
-    Cube,
-    Sphere,
-    Capsule,
-    OBJMesh  // New type for loaded OBJ models
-};
-
 enum class ConsoleMessageType {
     Info,
     Warning,
@@ -102,22 +133,124 @@ enum class ConsoleMessageType {
     Success
 };
 
-class SceneObject {
+// The scene's objects, stored as entities with the components in SceneComponents.h and
+// looked up by ObjectInfo::id in O(1). Entities stay in creation order: entityAt() is
+// what the hierarchy panel and the serializer walk, and what the scene AABB tree's
+// indices refer to.
+class SceneObjectStore {
 public:
-    std::string name;
-    ObjectType type;
-    glm::vec3 position;
-    glm::vec3 rotation;
-    glm::vec3 scale;
-    int id;
-    int parentId = -1;
-    std::vector<int> childIds;
-    bool isExpanded = true;
-    std::string meshPath;  // Path to OBJ file (for OBJMesh type)
-    int meshId = -1;       // Index into loaded meshes cache
-
-    SceneObject(const std::string& name, ObjectType type, int id)
-        : name(name), type(type), position(0.0f), rotation(0.0f), scale(1.0f), id(id) {}
+    // ObjectInfo and Transform, plus MeshRef and SpatialProxy or Light as the type needs
+    Entity create(int id, const std::string& name, ObjectType type) {
+        ObjectInfo info;
+        info.id = id;
+        info.name = name;
+        info.type = type;
+
+        Entity entity;
+        if (isLightType(type)) {
+            Light light;
+            light.spot = type == ObjectType::SpotLight;
+            entity = world.create(info, Transform(), light);
+        } else {
+            MeshRef mesh;
+            mesh.type = type;
+            entity = world.create(info, Transform(), mesh, SpatialProxy());
+        }
+        entitiesById[id] = entity;
+        touch();
+        return entity;
+    }
+
+    bool remove(int id) {
+        auto it = entitiesById.find(id);
+        if (it == entitiesById.end()) return false;
+        world.destroy(it->second);
+        entitiesById.erase(it);
+        touch();
+        return true;
+    }
+
+    void clear() {
+        world.clear();
+        entitiesById.clear();
+        touch();
+    }
+
+    // Takes a new value whenever objects are created, removed or relinked, and on touch(),
+    // which edits of names or expansion through component pointers must call. Values are
+    // unique across stores, so a store moved in from a scene load also reads as changed.
+    uint64_t getVersion() const { return version; }
+    void touch() { version = nextVersion(); }
+
+    // Invalid when there is no such object
+    Entity find(int id) const {
+        auto it = entitiesById.find(id);
+        return it != entitiesById.end() ? it->second : Entity();
+    }
+    // Position in creation order, or -1
+    int indexOf(int id) const { return world.indexOf(find(id)); }
+    Entity entityAt(size_t index) const { return world.entityAt(index); }
+    size_t size() const { return world.size(); }
+
+    template <typename T>
+    T* get(Entity entity) { return world.get<T>(entity); }
+    template <typename T>
+    const T* get(Entity entity) const { return world.get<T>(entity); }
+    template <typename T>
+    T* get(int id) { return world.get<T>(find(id)); }
+
+    int getParentId(Entity entity) const {
+        const Hierarchy* hierarchy = world.get<Hierarchy>(entity);
+        return hierarchy ? hierarchy->parentId : -1;
+    }
+    const std::vector<int>& getChildIds(Entity entity) const {
+        static const std::vector<int> none;
+        const Hierarchy* hierarchy = world.get<Hierarchy>(entity);
+        return hierarchy ? hierarchy->childIds : none;
+    }
+
+    // Moves the object under parentId (-1 for none), updating the links on both sides.
+    // Leaves transforms alone and doesn't check for cycles.
+    void link(int childId, int parentId) {
+        Entity child = find(childId);
+        int oldParentId = getParentId(child);
+        if (!world.isAlive(child) || oldParentId == parentId) return;
+
+        if (Hierarchy* oldParent = get<Hierarchy>(oldParentId)) {
+            auto& siblings = oldParent->childIds;
+            siblings.erase(std::remove(siblings.begin(), siblings.end(), childId), siblings.end());
+            pruneHierarchy(find(oldParentId));
+        }
+        if (parentId != -1) {
+            Entity parent = find(parentId);
+            if (!world.has<Hierarchy>(parent)) world.add(parent, Hierarchy());
+            world.get<Hierarchy>(parent)->childIds.push_back(childId);
+        }
+
+        if (!world.has<Hierarchy>(child)) world.add(child, Hierarchy());
+        world.get<Hierarchy>(child)->parentId = parentId;
+        pruneHierarchy(child);
+        touch();
+    }
+
+    EntityWorld& getWorld() { return world; }
+    const EntityWorld& getWorld() const { return world; }
+
+private:
+    EntityWorld world;
+    std::unordered_map<int, Entity> entitiesById;
+    uint64_t version = nextVersion();
+
+    static uint64_t nextVersion() {
+        static uint64_t counter = 0;
+        return ++counter;
+    }
+
+    // Objects outside any hierarchy don't carry the component
+    void pruneHierarchy(Entity entity) {
+        const Hierarchy* hierarchy = world.get<Hierarchy>(entity);
+        if (hierarchy && hierarchy->parentId == -1 && hierarchy->childIds.empty()) world.remove<Hierarchy>(entity);
+    }
 };
 
 class FileBrowser {
@@ -355,33 +488,99 @@ std::vector<float> generateCapsule(int segments = 16, int rings = 8) {
     return triangulated;
 }
 
+// Per-instance vertex stream read by vert.glsl (model at locations 3-6, normal matrix at 7-9)
+struct InstanceData {
+    glm::mat4 model;
+    glm::mat3 normalMatrix;
+};
+
+// One detail level: a range of the mesh's shared index buffer
+struct MeshLod {
+    size_t firstIndex = 0;
+    int indexCount = 0;
+    float error = 0.0f;  // simplification error relative to the mesh extent
+};
+
 class Mesh {
 private:
-    unsigned int VAO, VBO;
+    unsigned int VAO, VBO, EBO;
     int vertexCount;
+    int indexCount;
+    GLenum indexType;
+    VertexLayout layout;
+    MeshBounds bounds;
+    std::vector<MeshLod> lods;
+
+    static void setupAttribute(const VertexAttribute& attribute, size_t stride) {
+        GLenum type = GL_FLOAT;
+        GLboolean normalized = GL_FALSE;
+        switch (attribute.type) {
+            case VertexAttributeType::Float: type = GL_FLOAT; break;
+            case VertexAttributeType::HalfFloat: type = GL_HALF_FLOAT; break;
+            case VertexAttributeType::SNorm16: type = GL_SHORT; normalized = GL_TRUE; break;
+            case VertexAttributeType::UNorm16: type = GL_UNSIGNED_SHORT; normalized = GL_TRUE; break;
+        }
+        glVertexAttribPointer(attribute.location, attribute.components, type, normalized,
+                              static_cast<GLsizei>(stride), (void*)attribute.offset);
+        glEnableVertexAttribArray(attribute.location);
+    }
 
 public:
-    Mesh(const float* vertexData, size_t dataSizeBytes) {
-        vertexCount = dataSizeBytes / (8 * sizeof(float));
+    // Triangle soup of 8-float vertices; shared corners are welded into an index buffer
+    Mesh(const float* vertexData, size_t dataSizeBytes)
+        : Mesh(buildIndexedMesh(vertexData, dataSizeBytes / (8 * sizeof(float)), 8)) {}
+
+    // lodLevels[0] must be data.indices when given (see buildLodChain); every level
+    // shares the vertex buffer and is appended to the same element buffer
+    explicit Mesh(const IndexedMeshData& data, const std::vector<MeshLodLevel>& lodLevels = {}) {
+        vertexCount = static_cast<int>(data.getVertexCount());
+        indexCount = static_cast<int>(data.indices.size());
+        bounds = computeMeshBounds(data.vertices.data(), vertexCount, 8);
+
+        std::vector<uint32_t> allIndices;
+        if (lodLevels.empty()) {
+            allIndices = data.indices;
+            lods.push_back({ 0, indexCount, 0.0f });
+        } else {
+            for (const MeshLodLevel& level : lodLevels) {
+                lods.push_back({ allIndices.size(), static_cast<int>(level.indices.size()), level.error });
+                allIndices.insert(allIndices.end(), level.indices.begin(), level.indices.end());
+            }
+        }
+
+        // Upload in the most compact format the data allows
+        PackedVertexData packed = packVertices(data.vertices.data(), vertexCount);
+        layout = packed.layout;
 
         glGenVertexArrays(1, &VAO);
         glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
 
         glBindVertexArray(VAO);
         glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(GL_ARRAY_BUFFER, dataSizeBytes, vertexData, GL_STATIC_DRAW);
-
-        // 0: Position
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
+        glBufferData(GL_ARRAY_BUFFER, packed.bytes.size(), packed.bytes.data(), GL_STATIC_DRAW);
+
+        // The element buffer binding is VAO state, so it stays bound for drawInstanced()
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        if (vertexCount <= 0xFFFF) {
+            std::vector<uint16_t> shortIndices(allIndices.begin(), allIndices.end());
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, shortIndices.size() * sizeof(uint16_t), shortIndices.data(), GL_STATIC_DRAW);
+            indexType = GL_UNSIGNED_SHORT;
+        } else {
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, allIndices.size() * sizeof(uint32_t), allIndices.data(), GL_STATIC_DRAW);
+            indexType = GL_UNSIGNED_INT;
+        }
 
-        // 1: Normal
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-        glEnableVertexAttribArray(1);
+        // 0: Position, 1: Octahedral normal, 2: TexCoord
+        setupAttribute(layout.position, layout.stride);
+        setupAttribute(layout.normal, layout.stride);
+        setupAttribute(layout.texCoord, layout.stride);
 
-        // 2: TexCoord
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-        glEnableVertexAttribArray(2);
+        // 3-9: Per-instance model and normal matrices, pointed at a buffer in bindInstanceData()
+        for (unsigned int loc = 3; loc <= 9; loc++) {
+            glEnableVertexAttribArray(loc);
+            glVertexAttribDivisor(loc, 1);
+        }
 
         glBindBuffer(GL_ARRAY_BUFFER, 0);
         glBindVertexArray(0);
@@ -390,15 +589,43 @@ public:
     ~Mesh() {
         glDeleteVertexArrays(1, &VAO);
         glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &EBO);
     }
 
-    void draw() const {
-        glBindVertexArray(VAO);
-        glDrawArrays(GL_TRIANGLES, 0, vertexCount);
-        glBindVertexArray(0);
+    // Points the instance attributes at a range of InstanceData inside a shared buffer.
+    // GL 3.3 has no base-instance draws, so each batch rebinds with its own offset.
+    // Both this and drawInstanced() expect getVAO() to be bound.
+    void bindInstanceData(GLStateCache& state, unsigned int instanceBuffer, size_t byteOffset) const {
+        const GLsizei stride = sizeof(InstanceData);
+
+        state.bindArrayBuffer(instanceBuffer);
+
+        for (unsigned int col = 0; col < 4; col++) {
+            size_t offset = byteOffset + offsetof(InstanceData, model) + col * sizeof(glm::vec4);
+            glVertexAttribPointer(3 + col, 4, GL_FLOAT, GL_FALSE, stride, (void*)offset);
+        }
+        for (unsigned int col = 0; col < 3; col++) {
+            size_t offset = byteOffset + offsetof(InstanceData, normalMatrix) + col * sizeof(glm::vec3);
+            glVertexAttribPointer(7 + col, 3, GL_FLOAT, GL_FALSE, stride, (void*)offset);
+        }
+    }
+
+    void drawInstanced(int instanceCount, int lod = 0) const {
+        const MeshLod& level = lods[lod];
+        size_t indexSize = indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t);
+
+        glDrawElementsInstanced(GL_TRIANGLES, level.indexCount, indexType,
+                                (void*)(level.firstIndex * indexSize), instanceCount);
     }
     
+    unsigned int getVAO() const { return VAO; }
+    
     int getVertexCount() const { return vertexCount; }
+    int getIndexCount() const { return indexCount; }
+    const VertexLayout& getLayout() const { return layout; }
+    int getLodCount() const { return static_cast<int>(lods.size()); }
+    const MeshLod& getLod(int lod) const { return lods[lod]; }
+    const MeshBounds& getBounds() const { return bounds; }
 };
 
 class OBJLoader {
@@ -407,25 +634,99 @@ public:
         std::string path;
         std::unique_ptr<Mesh> mesh;
         std::string name;
-        int vertexCount = 0;
+        int vertexCount = 0;   // unique vertices after welding
+        int indexCount = 0;
         int faceCount = 0;
         bool hasNormals = false;
         bool hasTexCoords = false;
+        MeshBounds bounds;
     };
     
 private:
     std::vector<LoadedMesh> loadedMeshes;
     
+    // What loadOBJ() does before touching GL, so it can run on a job worker
+    struct ParsedOBJ {
+        std::string path;
+        bool valid = false;
+        std::string errorMsg;
+        IndexedMeshData indexed;
+        std::vector<MeshLodLevel> lodLevels;
+        int faceCount = 0;
+        bool hasNormals = false;
+        bool hasTexCoords = false;
+    };
+
 public:
     // Load an OBJ file and return index into cache, or -1 on failure
     int loadOBJ(const std::string& filepath, std::string& errorMsg) {
-        // Check if already loaded
+        PROFILE_SCOPE("OBJLoader::loadOBJ");
+        int cached = findOBJ(filepath);
+        if (cached >= 0) return cached;
+
+        ParsedOBJ parsed = parseOBJ(filepath);
+        return addParsedOBJ(parsed, errorMsg);
+    }
+
+    // Parses the files that aren't loaded yet in parallel on the job workers, then uploads
+    // them in order. Failures are appended to errorMsg; loadOBJ() afterwards returns the
+    // cached meshes.
+    void loadOBJs(const std::vector<std::string>& filepaths, JobSystem& jobs, std::string& errorMsg) {
+        PROFILE_SCOPE("OBJLoader::loadOBJs");
+        std::vector<ParsedOBJ> parsed;
+        for (const std::string& filepath : filepaths) {
+            if (findOBJ(filepath) >= 0) continue;
+            bool queued = false;
+            for (const ParsedOBJ& other : parsed) queued |= other.path == filepath;
+            if (queued) continue;
+            parsed.emplace_back();
+            parsed.back().path = filepath;
+        }
+
+        jobs.parallelFor(parsed.size(), 1, [&parsed](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) parsed[i] = parseOBJ(parsed[i].path);
+        });
+        for (ParsedOBJ& mesh : parsed) {
+            std::string meshError;
+            if (addParsedOBJ(mesh, meshError) < 0) errorMsg += meshError + "\n";
+        }
+    }
+
+    // Parses on a job worker, then uploads and calls onLoaded(meshIndex, errorMsg) on the
+    // main thread; meshIndex is -1 on failure
+    JobHandle loadOBJAsync(const std::string& filepath, JobSystem& jobs,
+                           std::function<void(int, const std::string&)> onLoaded) {
+        std::shared_ptr<ParsedOBJ> parsed = std::make_shared<ParsedOBJ>();
+        parsed->path = filepath;
+        JobHandle parse;
+        if (findOBJ(filepath) < 0) {
+            parse = jobs.schedule([parsed]() { *parsed = parseOBJ(parsed->path); });
+        }
+        return jobs.runOnMainThread([this, parsed, onLoaded]() {
+            std::string errorMsg;
+            int meshId = findOBJ(parsed->path);
+            if (meshId < 0) meshId = addParsedOBJ(*parsed, errorMsg);
+            onLoaded(meshId, errorMsg);
+        }, { parse });
+    }
+
+    int findOBJ(const std::string& filepath) const {
         for (size_t i = 0; i < loadedMeshes.size(); i++) {
             if (loadedMeshes[i].path == filepath) {
                 return static_cast<int>(i);
             }
         }
-        
+        return -1;
+    }
+
+private:
+    // Reads, welds and simplifies the file without touching GL or the cache, so any thread
+    // may call it
+    static ParsedOBJ parseOBJ(const std::string& filepath) {
+        PROFILE_SCOPE("OBJLoader::parseOBJ");
+        ParsedOBJ parsed;
+        parsed.path = filepath;
+
         tinyobj::attrib_t attrib;
         std::vector<tinyobj::shape_t> shapes;
         std::vector<tinyobj::material_t> materials;
@@ -438,16 +739,16 @@ public:
                                     filepath.c_str(), baseDir.c_str());
         
         if (!warn.empty()) {
-            errorMsg += "Warning: " + warn + "\n";
+            parsed.errorMsg += "Warning: " + warn + "\n";
         }
         
         if (!err.empty()) {
-            errorMsg += "Error: " + err + "\n";
+            parsed.errorMsg += "Error: " + err + "\n";
         }
         
         if (!ret || shapes.empty()) {
-            errorMsg += "Failed to load OBJ file: " + filepath;
-            return -1;
+            parsed.errorMsg += "Failed to load OBJ file: " + filepath;
+            return parsed;
         }
         
         // Convert to our vertex format (pos + uv)
@@ -541,24 +842,48 @@ public:
         }
 
         if (vertices.empty()) {
-            errorMsg += "No vertices found in OBJ file";
+            parsed.errorMsg += "No vertices found in OBJ file";
+            return parsed;
+        }
+
+        // Weld the corners into shared vertices and order triangles for the vertex cache
+        parsed.indexed = buildIndexedMesh(vertices.data(), vertices.size() / 8, 8);
+        parsed.lodLevels = buildLodChain(parsed.indexed, { 0.5f, 0.25f, 0.1f });
+        parsed.faceCount = faceCount;
+        parsed.hasNormals = hasNormalsInFile;
+        parsed.hasTexCoords = !attrib.texcoords.empty();
+        parsed.valid = true;
+        return parsed;
+    }
+
+    // Creates the GL mesh for a parsed file; main thread only. A file loaded meanwhile is
+    // returned from the cache.
+    int addParsedOBJ(ParsedOBJ& parsed, std::string& errorMsg) {
+        int cached = findOBJ(parsed.path);
+        if (cached >= 0) return cached;
+        if (!parsed.valid) {
+            errorMsg += parsed.errorMsg;
             return -1;
         }
 
         // Create mesh
         LoadedMesh loaded;
-        loaded.path = filepath;
-        loaded.name = fs::path(filepath).stem().string();
-        loaded.mesh = std::make_unique<Mesh>(vertices.data(), vertices.size() * sizeof(float));
-        loaded.vertexCount = static_cast<int>(vertices.size() / 8);
-        loaded.faceCount = faceCount;
-        loaded.hasNormals = hasNormalsInFile;
-        loaded.hasTexCoords = !attrib.texcoords.empty();
+        loaded.path = parsed.path;
+        loaded.name = fs::path(parsed.path).stem().string();
+        loaded.mesh = std::make_unique<Mesh>(parsed.indexed, parsed.lodLevels);
+        loaded.vertexCount = static_cast<int>(parsed.indexed.getVertexCount());
+        loaded.indexCount = static_cast<int>(parsed.indexed.indices.size());
+        loaded.faceCount = parsed.faceCount;
+        loaded.hasNormals = parsed.hasNormals;
+        loaded.hasTexCoords = parsed.hasTexCoords;
+        loaded.bounds = loaded.mesh->getBounds();
+        errorMsg += parsed.errorMsg;  // warnings
 
         loadedMeshes.push_back(std::move(loaded));
         return static_cast<int>(loadedMeshes.size() - 1);
     }
-    
+
+public:
     // Get mesh by index
     Mesh* getMesh(int index) {
         if (index < 0 || index >= static_cast<int>(loadedMeshes.size())) {
@@ -732,10 +1057,31 @@ public:
     }
 };
 
+enum class RenderPassType {
+    Opaque,
+    Skybox
+};
+
+struct RenderPass {
+    RenderPassType type;
+    const char* name;
+};
+
 class Renderer {
 private:
-    unsigned int framebuffer = 0, viewportTexture = 0, rbo = 0;
+    // Viewport size requested by the editor, and the part of it the pooled scene target
+    // covers this frame (smaller only while a resize settles; the image is stretched).
+    // With dynamic resolution only renderWidth x renderHeight of that is drawn and the
+    // upsampler fills the rest.
+    RenderTargetPool renderTargets;
+    int sceneTargetSlot = -1;
+    RenderTargetView sceneTarget;
+    RenderTargetView viewportImage;
     int currentWidth = 800, currentHeight = 600;
+    int displayWidth = 800, displayHeight = 600;
+    int renderWidth = 800, renderHeight = 600;
+    DynamicResolution* dynamicResolution = nullptr;
+    TemporalUpsampler* upsampler = nullptr;
     Shader* shader = nullptr;
     Texture* texture1 = nullptr;
     Texture* texture2 = nullptr;
@@ -743,6 +1089,111 @@ private:
     Mesh* sphereMesh = nullptr;
     Mesh* capsuleMesh = nullptr;
     Skybox* skybox = nullptr;
+    UniformBuffer* frameUniforms = nullptr;
+
+    // Sky ambient: SH9 irradiance re-projected only when the sky's time of day moves
+    UniformBuffer* ambientUniforms = nullptr;
+    SHProjector ambientProjector;
+    SH9 ambientSH = {};
+    float ambientTimeOfDay = -1.0f;
+
+    // Clustered forward lighting: light objects are binned into froxels every frame and
+    // the lists reach frag.glsl through buffer textures on these units
+    enum LightTextureUnit { LightDataUnit = 2, ClusterGridUnit = 3, LightIndexUnit = 4, ShadowMapUnit = 5 };
+    LightClusterGrid lightClusters;
+    std::vector<GPULight> sceneLights;
+    TextureBuffer* lightDataBuffer = nullptr;
+    TextureBuffer* clusterGridBuffer = nullptr;
+    TextureBuffer* lightIndexBuffer = nullptr;
+    UniformBuffer* clusterUniforms = nullptr;
+
+    // Sun shadows: cascades fitted on the CPU, static casters cached per cascade and
+    // dynamic casters drawn over the cache each frame
+    Shader* shadowShader = nullptr;
+    int shadowMatrixLocation = -1;
+    CascadedShadowMap* shadowMap = nullptr;
+    UniformBuffer* shadowUniforms = nullptr;
+    unsigned int shadowInstanceVBO = 0;
+    size_t shadowInstanceCapacity = 0;
+    std::vector<int> shadowCandidates;
+    std::vector<int> shadowStaticCasters;
+    std::vector<int> shadowDynamicCasters;
+    typedef std::pair<const Mesh*, Entity> ShadowCaster;
+    std::vector<ShadowCaster> shadowCasterMeshes;
+    std::vector<InstanceData> shadowInstances;
+    int shadowDrawsThisFrame = 0;
+
+    // Submission: every draw is queued with a sort key, then replayed through the state cache
+    enum ShaderKey { MainShaderKey = 0, SkyboxShaderKey = 1 };
+    enum class DrawItemType { MeshBatch, Skybox };
+    struct DrawItem {
+        DrawItemType type;
+        RenderPassType pass = RenderPassType::Opaque;
+        unsigned int program = 0;
+        unsigned int vertexArray = 0;
+        int textureSet = -1;
+        unsigned int depthFunc = GL_LESS;
+        int batch = -1;  // index into drawBatches
+    };
+    struct TextureSet {
+        unsigned int textures[2];
+    };
+    std::vector<TextureSet> textureSets;
+    RenderQueue renderQueue;
+    std::vector<DrawItem> drawItems;
+    GLStateCache stateCache;
+    int stateValidationInterval = 120;
+    GpuProfiler* gpuProfiler = nullptr;  // owned by the editor; null when not profiling
+    JobSystem* jobs = nullptr;           // owned by the editor; null runs everything here
+    const TransformHierarchy* frameTransforms = nullptr;  // the current renderScene()'s
+
+    std::vector<RenderPass> framePasses;
+    unsigned long long frameIndex = 0;
+    int viewportDrawsThisFrame = 0;
+
+    // Instanced submission: objects are grouped by mesh and every group is one draw
+    struct DrawBatch {
+        const Mesh* mesh = nullptr;
+        int lod = 0;
+        size_t first = 0;
+        size_t count = 0;
+        float nearestDistance = 0.0f;  // closest instance, for front-to-back sorting
+    };
+    struct BatchKey {
+        const Mesh* mesh;
+        int lod;
+        bool operator==(const BatchKey& other) const { return mesh == other.mesh && lod == other.lod; }
+    };
+    struct BatchKeyHash {
+        size_t operator()(const BatchKey& key) const {
+            return std::hash<const Mesh*>()(key.mesh) ^ (static_cast<size_t>(key.lod) * 0x9E3779B9u);
+        }
+    };
+    unsigned int instanceVBO = 0;
+    size_t instanceCapacity = 0;
+    std::vector<DrawBatch> drawBatches;
+    std::unordered_map<BatchKey, size_t, BatchKeyHash> batchLookup;
+    std::vector<int> visibleBatch;  // batch of each visible object, then its instanceData slot
+    std::vector<InstanceData> instanceData;
+    int drawCallsThisFrame = 0;
+    int trianglesThisFrame = 0;
+
+    // LOD chosen last frame per scene object index (the hysteresis reference) and this frame per visible object
+    std::vector<uint8_t> objectLod;
+    std::vector<int> visibleLod;
+    std::vector<float> visibleDistance;
+
+    // Frustum culling scratch: the tree's candidates, their world boxes and the kernel's verdicts
+    std::vector<int> cullCandidates;
+    std::vector<glm::mat4> candidateModels;
+    std::vector<const Mesh*> candidateMeshes;
+    AABBList cullBoxes;
+    std::vector<uint8_t> cullVisible;
+    std::vector<int> visibleObjects;
+    std::vector<const Mesh*> visibleMeshes;
+    std::vector<glm::mat4> visibleModels;
+    int culledObjectCount = 0;
+    int visibleObjectCount = 0;
 
 public:
     Renderer() = default;
@@ -754,9 +1205,19 @@ public:
         delete sphereMesh;
         delete capsuleMesh;
         delete skybox;
-        if (framebuffer) glDeleteFramebuffers(1, &framebuffer);
-        if (viewportTexture) glDeleteTextures(1, &viewportTexture);
-        if (rbo) glDeleteRenderbuffers(1, &rbo);
+        delete frameUniforms;
+        delete ambientUniforms;
+        delete lightDataBuffer;
+        delete clusterGridBuffer;
+        delete lightIndexBuffer;
+        delete clusterUniforms;
+        delete shadowShader;
+        delete shadowMap;
+        delete shadowUniforms;
+        if (shadowInstanceVBO) glDeleteBuffers(1, &shadowInstanceVBO);
+        delete dynamicResolution;
+        delete upsampler;
+        if (instanceVBO) glDeleteBuffers(1, &instanceVBO);
     }
 
     void initialize() {
@@ -768,8 +1229,45 @@ public:
             throw std::runtime_error("Shader error");
         }
 
+        shader->bindUniformBlock("FrameData", FRAME_UNIFORM_BINDING);
+        shader->bindUniformBlock("AmbientData", AMBIENT_UNIFORM_BINDING);
+        shader->bindUniformBlock("ClusterData", CLUSTER_UNIFORM_BINDING);
+        shader->bindUniformBlock("ShadowData", SHADOW_UNIFORM_BINDING);
+        shader->use();
+        shader->setInt("texture1", 0);
+        shader->setInt("texture2", 1);
+        shader->setInt("lightData", LightDataUnit);
+        shader->setInt("clusterGrid", ClusterGridUnit);
+        shader->setInt("lightIndices", LightIndexUnit);
+        shader->setInt("shadowMap", ShadowMapUnit);
+        // Material constants never change, so they live in the program like the samplers
+        shader->setFloat("ambientStrength", 1.0f);
+        shader->setFloat("specularStrength", 0.8f);
+        shader->setFloat("shininess", 64.0f);
+        shader->setFloat("mixAmount", 0.3f);
+
+        frameUniforms = new UniformBuffer(sizeof(FrameUniforms), FRAME_UNIFORM_BINDING);
+        ambientUniforms = new UniformBuffer(sizeof(AmbientUniforms), AMBIENT_UNIFORM_BINDING);
+        clusterUniforms = new UniformBuffer(sizeof(ClusterUniforms), CLUSTER_UNIFORM_BINDING);
+        lightDataBuffer = new TextureBuffer(GL_RGBA32F);
+        clusterGridBuffer = new TextureBuffer(GL_RG32UI);
+        lightIndexBuffer = new TextureBuffer(GL_R32UI);
+
+        shadowShader = new Shader("Resources/Shaders/shadow_vert.glsl", "Resources/Shaders/shadow_frag.glsl");
+        if (shadowShader->ID == 0) {
+            std::cerr << "Shadow shader compilation failed!\n";
+            delete shadowShader;
+            shadowShader = nullptr;
+            throw std::runtime_error("Shader error");
+        }
+        shadowMatrixLocation = shadowShader->getUniformLocation("lightViewProjection");
+        shadowMap = new CascadedShadowMap();
+        shadowUniforms = new UniformBuffer(sizeof(ShadowUniforms), SHADOW_UNIFORM_BINDING);
+        glGenBuffers(1, &shadowInstanceVBO);
+
         texture1 = new Texture("Resources/Textures/container.jpg");
         texture2 = new Texture("Resources/Textures/awesomeface.png");
+        textureSets.push_back({ { texture1->GetID(), texture2->GetID() } });
 
         cubeMesh = new Mesh(vertices, sizeof(vertices));
 
@@ -781,190 +1279,609 @@ public:
 
         skybox = new Skybox();
 
-        setupFBO();
+        glGenBuffers(1, &instanceVBO);
+
+        dynamicResolution = new DynamicResolution();
+        upsampler = new TemporalUpsampler(renderTargets);
+
+        RenderTargetDesc sceneDesc;
+        sceneDesc.colorFormat = GL_RGB8;
+        // A texture rather than a renderbuffer: the upsampler reprojects with the depth
+        sceneDesc.depthFormat = GL_DEPTH24_STENCIL8;
+        sceneTargetSlot = renderTargets.createSlot(sceneDesc);
+
         glEnable(GL_DEPTH_TEST);
     }
 
+    // Only records the size; the scene target follows it through the pool, which waits
+    // for the size to settle before reallocating
     void resize(int w, int h) {
-        if (w <= 0 || h <= 0 || (w == currentWidth && h == currentHeight)) return;
-        
-        std::cout << "RESIZE TRIGGERED: " << w << "x" << h << std::endl;
-        
-        GLint currentFB;
-        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &currentFB);
-        std::cout << "Framebuffer bound during resize: " << currentFB << " (should be " << framebuffer << ")" << std::endl;
-        
+        if (w <= 0 || h <= 0) return;
         currentWidth = w;
         currentHeight = h;
-        
-        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
-        
-        glBindTexture(GL_TEXTURE_2D, viewportTexture);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, currentWidth, currentHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
-        glBindRenderbuffer(GL_RENDERBUFFER, rbo);
-        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, currentWidth, currentHeight);
-
-        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
-            std::cerr << "Framebuffer incomplete after resize!\n";
-        }
-        
-        std::cout << "Resize complete" << std::endl;
     }
 
     int getWidth() const { return currentWidth; }
     int getHeight() const { return currentHeight; }
+    int getRenderWidth() const { return renderWidth; }
+    int getRenderHeight() const { return renderHeight; }
+
+    // Renders the scene below the viewport size when the GPU time of the viewport would
+    // exceed the budget, and upsamples it temporally. Disabled renders at full size.
+    void setDynamicResolution(bool enabled, float budgetMilliseconds) {
+        if (enabled && !dynamicResolution->isEnabled()) upsampler->resetHistory();
+        dynamicResolution->setEnabled(enabled);
+        dynamicResolution->setBudget(budgetMilliseconds);
+    }
+    float getResolutionScale() const { return dynamicResolution->getScale(); }
+    // Frames to keep rendering an unchanged view so the image reaches full quality
+    int getConvergenceFrames() const { return dynamicResolution->isEnabled() ? TemporalUpsampler::ConvergenceFrames : 0; }
+    // False while the viewport target is still waiting to move to the bucket of the
+    // viewport's size; renderScene() has to keep being called until it does
+    bool isViewportSettled() const { return renderTargets.isSlotSettled(sceneTargetSlot); }
+    float getViewportGpuTime() const { return dynamicResolution->getGpuTime(); }
+
+    // Starts a new editor frame. The pass list is rebuilt here and the viewport
+    // target may only be submitted once until the next call.
+    void beginFrame() {
+        frameIndex++;
+        viewportDrawsThisFrame = 0;
+        // ImGui and resource creation touch GL between frames
+        stateCache.invalidate();
+        renderTargets.beginFrame(stateCache);
+
+        framePasses.clear();
+        framePasses.push_back({ RenderPassType::Opaque, "Opaque" });
+        if (skybox) {
+            framePasses.push_back({ RenderPassType::Skybox, "Skybox" });
+        }
+    }
 
-    void beginRender(const glm::mat4& view, const glm::mat4& proj) {
-        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
-        glViewport(0, 0, currentWidth, currentHeight);
-        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    // Passes are timed as scopes of the editor's profiler, named after the passes
+    void setGpuProfiler(GpuProfiler* profiler) { gpuProfiler = profiler; }
+    // Per-object preparation, light binning and the ambient projection run on its workers
+    void setJobSystem(JobSystem* jobSystem) { jobs = jobSystem; }
 
-        shader->use();
-        shader->setMat4("view", view);
-        shader->setMat4("projection", proj);
-        texture1->Bind(GL_TEXTURE0);
-        texture2->Bind(GL_TEXTURE1);
-        shader->setInt("texture1", 0);
-        shader->setInt("texture2", 1);
+    unsigned long long getFrameIndex() const { return frameIndex; }
+    const std::vector<RenderPass>& getFramePasses() const { return framePasses; }
+
+    Skybox* getSkybox() { return skybox; }
+    const SH9& getAmbientSH() const { return ambientSH; }
+    int getLightCount() const { return static_cast<int>(sceneLights.size()); }
+    int getShadowDrawCount() const { return shadowDrawsThisFrame; }
+
+    // Call when a static object was added, removed, moved or changed its static flag
+    void invalidateStaticShadows() {
+        if (shadowMap) shadowMap->invalidateStatic();
+    }
+    // Per-object state is kept by scene object index: call when the object at index was
+    // erased and the ones after it shifted down, or with clear when the scene was replaced
+    void removeObjectState(size_t index) {
+        if (index < objectLod.size()) objectLod.erase(objectLod.begin() + index);
+    }
+    void clearObjectState() { objectLod.clear(); }
+    int getMaxLightsPerCluster() const { return lightClusters.getMaxLightsPerCluster(); }
+
+    int getDrawCallCount() const { return drawCallsThisFrame; }
+    int getTriangleCount() const { return trianglesThisFrame; }
+    int getStateChangeCount() const { return stateCache.getIssuedCount(); }
+    int getSkippedStateChangeCount() const { return stateCache.getSkippedCount(); }
+    int getCulledObjectCount() const { return culledObjectCount; }
+    int getVisibleObjectCount() const { return visibleObjectCount; }
+
+    const glm::mat4& worldMatrix(const Transform& transform) const {
+        return frameTransforms->getWorldMatrix(transform.node);
+    }
+
+    const Mesh* getMesh(const MeshRef& mesh) const {
+        switch (mesh.type) {
+            case ObjectType::Cube: return cubeMesh;
+            case ObjectType::Sphere: return sphereMesh;
+            case ObjectType::Capsule: return capsuleMesh;
+            case ObjectType::OBJMesh: return mesh.meshId >= 0 ? g_objLoader.getMesh(mesh.meshId) : nullptr;
+            case ObjectType::PointLight:
+            case ObjectType::SpotLight: return nullptr;
+        }
+        return nullptr;
     }
 
-    void renderSkybox(const glm::mat4& view, const glm::mat4& proj) {
+    // Single scene submission for the frame: clears the viewport target once and
+    // runs every pass built in beginFrame() into it. sceneTree's user data are positions in
+    // the world's creation order; transforms holds the world matrices and must be up to date.
+    void renderScene(const Camera& camera, const EntityWorld& world, const AABBTree& sceneTree,
+                     const TransformHierarchy& transforms) {
+        PROFILE_SCOPE("Renderer::renderScene");
+        frameTransforms = &transforms;
+        assert(viewportDrawsThisFrame == 0 && "Viewport target submitted more than once in a frame");
+        viewportDrawsThisFrame++;
+        // Reset here rather than in beginFrame() so the stats describe the image on screen
+        // while the editor reuses it
+        drawCallsThisFrame = 0;
+        shadowDrawsThisFrame = 0;
+        trianglesThisFrame = 0;
+        culledObjectCount = 0;
+        visibleObjectCount = 0;
+        stateCache.resetCounters();
+
+        sceneTarget = renderTargets.resolveSlot(stateCache, sceneTargetSlot, currentWidth, currentHeight);
+        displayWidth = sceneTarget.width;
+        displayHeight = sceneTarget.height;
+
+        dynamicResolution->update();
+        bool upsample = dynamicResolution->isEnabled();
+        float scale = dynamicResolution->getScale();
+        renderWidth = std::max(1, static_cast<int>(displayWidth * scale + 0.5f));
+        renderHeight = std::max(1, static_cast<int>(displayHeight * scale + 0.5f));
+        dynamicResolution->beginTiming();
+
+        // Per-frame data for every program bound to the FrameData block, uploaded once.
+        // The upsampler needs a different sub-pixel offset in every frame's projection.
+        FrameUniforms frame;
+        frame.view = camera.getViewMatrix();
+        glm::mat4 projection = glm::perspective(glm::radians(FOV), (float)currentWidth / (float)currentHeight, NEAR_PLANE, FAR_PLANE);
+        glm::vec2 jitter(0.0f);
+        if (upsample) jitter = TemporalUpsampler::getJitter(frameIndex);
+        frame.projection = upsample ? TemporalUpsampler::jitterProjection(projection, jitter, renderWidth, renderHeight) : projection;
+        // The key light is the sun: w = 0 marks lightPos as a direction
+        glm::vec3 sunDirection = glm::normalize(glm::vec3(0.4f, 0.6f, 0.4f));
+        glm::vec3 sunColor(1.0f);
         if (skybox) {
-            GLint currentFB;
-            glGetIntegerv(GL_FRAMEBUFFER_BINDING, &currentFB);
-            
-            glDepthFunc(GL_LEQUAL);
-            skybox->draw(glm::value_ptr(view), glm::value_ptr(proj));
-            glDepthFunc(GL_LESS);
-            
-            GLint afterFB;
-            glGetIntegerv(GL_FRAMEBUFFER_BINDING, &afterFB);
-            
-            if (currentFB != afterFB) {
-                std::cerr << "WARNING: Framebuffer changed during skybox render! " 
-                        << currentFB << " -> " << afterFB << std::endl;
-                glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+            sunDirection = Skybox::getSunDirection(skybox->getTimeOfDay());
+            sunColor = Skybox::getSunColor(skybox->getTimeOfDay());
+        }
+        frame.lightPos = glm::vec4(sunDirection, 0.0f);
+        frame.lightColor = glm::vec4(sunColor, 1.0f);
+        frame.viewPos = glm::vec4(camera.position, 1.0f);
+        frameUniforms->update(&frame, sizeof(frame));
+
+        updateAmbient();
+        buildLightClusters(world, frame);
+
+        // Before the viewport target is bound: both render into their own framebuffers
+        if (skybox) {
+            GpuProfileScope bakeScope(gpuProfiler, "Sky Bake");
+            skybox->updateBake(stateCache);
+        }
+        {
+            GpuProfileScope shadowScope(gpuProfiler, "Shadows");
+            renderShadows(world, sceneTree, frame.view, projection, sunDirection, sunColor);
+        }
+
+        {
+            GpuProfileScope clearScope(gpuProfiler, "Clear");
+            beginRender();
+        }
+
+        renderQueue.clear();
+        drawItems.clear();
+        for (const RenderPass& pass : framePasses) {
+            switch (pass.type) {
+                case RenderPassType::Opaque:
+                    queueOpaquePass(world, sceneTree, frame);
+                    break;
+                case RenderPassType::Skybox:
+                    queueSkybox();
+                    break;
             }
-            
-            shader->use();
-            shader->setMat4("view", view);
-            shader->setMat4("projection", proj);
-            shader->use();
         }
-    }
 
-    Skybox* getSkybox() { return skybox; }
+        renderQueue.sort();
+        submitQueue();
 
-    void renderObject(const SceneObject& obj) {
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::translate(model, obj.position);
-        model = glm::rotate(model, glm::radians(obj.rotation.x), glm::vec3(1, 0, 0));
-        model = glm::rotate(model, glm::radians(obj.rotation.y), glm::vec3(0, 1, 0));
-        model = glm::rotate(model, glm::radians(obj.rotation.z), glm::vec3(0, 0, 1));
-        model = glm::scale(model, obj.scale);
+        viewportImage = sceneTarget;
+        if (upsample) {
+            GpuProfileScope upsampleScope(gpuProfiler, "Upsample");
+            upsampler->resolve(stateCache, sceneTarget, displayWidth, displayHeight, jitter, projection * frame.view);
+            viewportImage = upsampler->getOutput();
+        }
+        dynamicResolution->endTiming();
 
-        shader->setMat4("model", model);
+        endRender();
+    }
 
-        switch (obj.type) {
-            case ObjectType::Cube:
-                cubeMesh->draw();
-                break;
-            case ObjectType::Sphere:
-                sphereMesh->draw();
-                break;
-            case ObjectType::Capsule:
-                capsuleMesh->draw();
-                break;
-            case ObjectType::OBJMesh:
-                // Draw loaded OBJ mesh
-                if (obj.meshId >= 0) {
-                    Mesh* objMesh = g_objLoader.getMesh(obj.meshId);
-                    if (objMesh) {
-                        objMesh->draw();
-                    }
-                }
-                break;
+    void endRender() {
+#ifdef MODULARITY_GL_VALIDATION
+        if (stateValidationInterval > 0 && frameIndex % static_cast<unsigned long long>(stateValidationInterval) == 0) {
+            stateCache.validate();
         }
+#endif
+        stateCache.bindFramebuffer(0);
     }
 
-    void renderScene(const Camera& camera, const std::vector<SceneObject>& sceneObjects) {
-        shader->use();
-        shader->setMat4("view", camera.getViewMatrix());
-        shader->setMat4("projection", glm::perspective(glm::radians(FOV), (float)currentWidth / (float)currentHeight, NEAR_PLANE, FAR_PLANE));
-        shader->setVec3("lightPos", glm::vec3(4.0f, 6.0f, 4.0f));  // Slightly higher and farther
-        shader->setVec3("lightColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        shader->setFloat("ambientStrength", 0.25f);
-        shader->setFloat("specularStrength", 0.8f);
-        shader->setFloat("shininess", 64.0f);
-        shader->setFloat("mixAmount", 0.3f);
+    // Frames between GL state cross-checks in validation builds; 0 disables them
+    void setStateValidationInterval(int frames) { stateValidationInterval = frames; }
+
+    // Image of the last renderScene() for ImGui::Image. It fills the lower-left corner of
+    // the texture up to getViewportUVScale().
+    unsigned int getViewportTexture() const { return viewportImage.target ? viewportImage.target->colorTexture : 0; }
+    glm::vec2 getViewportUVScale() const { return viewportImage.uvScale; }
+    size_t getRenderTargetCount() const { return renderTargets.getTargetCount(); }
+    int getRenderTargetAllocations() const { return renderTargets.getAllocationCount(); }
+
+private:
+    void beginRender() {
+        stateCache.bindFramebuffer(sceneTarget.target->framebuffer);
+        glViewport(0, 0, renderWidth, renderHeight);
+        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
+
+    // Projects the sky onto SH9 and uploads the irradiance when the time of day changed.
+    void updateAmbient() {
+        PROFILE_SCOPE("Renderer::updateAmbient");
+        if (!skybox || skybox->getTimeOfDay() == ambientTimeOfDay) return;
+        ambientTimeOfDay = skybox->getTimeOfDay();
+
+        float timeOfDay = ambientTimeOfDay;
+        SH9 radiance = ambientProjector.project([timeOfDay](const glm::vec3& direction) {
+            return Skybox::evaluateSky(direction, timeOfDay);
+        }, jobs);
+        ambientSH = convolveLambertian(radiance);
+
+        AmbientUniforms ambient;
+        for (int k = 0; k < 9; k++) ambient.sh[k] = glm::vec4(ambientSH.coefficients[k], 0.0f);
+        ambientUniforms->update(&ambient, sizeof(ambient));
+    }
+
+    // Gathers the light objects, bins them into the froxel grid and uploads the light data,
+    // per-cluster ranges and index lists for frag.glsl
+    void buildLightClusters(const EntityWorld& world, const FrameUniforms& frame) {
+        PROFILE_SCOPE("Renderer::buildLightClusters");
+        // Only the Light and Transform arrays are read; each chunk fills its own slice
+        sceneLights.resize(world.count<Light, Transform>());
+        world.parallelEachChunk<Light, Transform>([this](size_t first, size_t count, const Entity*,
+                                                         const Light* lights, const Transform* lightTransforms) {
+            for (size_t i = 0; i < count; i++) {
+                const Light& source = lights[i];
+                const glm::mat4& model = worldMatrix(lightTransforms[i]);
+                GPULight& light = sceneLights[first + i];
+                light.positionRange = glm::vec4(glm::vec3(model[3]), source.range);
+                light.colorType = glm::vec4(source.color * source.intensity,
+                                            static_cast<float>(source.spot ? LightType::Spot : LightType::Point));
+                glm::vec3 direction = glm::normalize(glm::vec3(model * glm::vec4(0.0f, -1.0f, 0.0f, 0.0f)));
+                float outer = glm::clamp(source.spotOuterAngle, 0.0f, 89.0f);
+                float inner = glm::clamp(source.spotInnerAngle, 0.0f, outer);
+                light.directionCosOuter = glm::vec4(direction, std::cos(glm::radians(outer)));
+                light.cosInner = glm::vec4(std::cos(glm::radians(inner)), 0.0f, 0.0f, 0.0f);
+            }
+        }, jobs);
+
+        lightClusters.setProjection(frame.projection, NEAR_PLANE, FAR_PLANE);
+        lightClusters.build(sceneLights, frame.view, jobs);
+
+        lightDataBuffer->update(sceneLights.data(), sceneLights.size() * sizeof(GPULight));
+        const std::vector<uint32_t>& ranges = lightClusters.getClusterRanges();
+        clusterGridBuffer->update(ranges.data(), ranges.size() * sizeof(uint32_t));
+        const std::vector<uint32_t>& indices = lightClusters.getLightIndices();
+        lightIndexBuffer->update(indices.data(), indices.size() * sizeof(uint32_t));
+
+        ClusterUniforms clusters;
+        clusters.dims = glm::uvec4(LightClusterGrid::TilesX, LightClusterGrid::TilesY, LightClusterGrid::Slices,
+                                   static_cast<unsigned int>(sceneLights.size()));
+        clusters.scale = glm::vec4(static_cast<float>(LightClusterGrid::TilesX) / renderWidth,
+                                   static_cast<float>(LightClusterGrid::TilesY) / renderHeight,
+                                   lightClusters.getSliceScale(), lightClusters.getSliceBias());
+        clusterUniforms->update(&clusters, sizeof(clusters));
+    }
+
+    // Sun shadows for this frame. Per cascade the static cache is only redrawn when the
+    // cascade reports it dirty, and the sampled layer only touched when the cache changed
+    // or dynamic casters are (or were last frame) inside the cascade. The cascades are
+    // fitted to the unjittered projection so the upsampler's jitter can't move them.
+    void renderShadows(const EntityWorld& world, const AABBTree& sceneTree, const glm::mat4& view,
+                       const glm::mat4& projection, const glm::vec3& sunDirection, const glm::vec3& sunColor) {
+        PROFILE_SCOPE("Renderer::renderShadows");
+        ShadowUniforms uniforms = {};
+        // No shadow work at all once the sun has set
+        if (sunColor == glm::vec3(0.0f)) {
+            shadowUniforms->update(&uniforms, sizeof(uniforms));
+            return;
+        }
 
-        texture1->Bind(0);
-        texture2->Bind(1);
+        shadowMap->update(view, projection, NEAR_PLANE, SHADOW_DISTANCE, sunDirection);
 
-        for (const auto& obj : sceneObjects) {
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, obj.position);
-            model = glm::rotate(model, glm::radians(obj.rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
-            model = glm::rotate(model, glm::radians(obj.rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
-            model = glm::rotate(model, glm::radians(obj.rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
-            model = glm::scale(model, obj.scale);
+        stateCache.useProgram(shadowShader->ID);
+        stateCache.setDepthFunc(GL_LESS);
+        glEnable(GL_POLYGON_OFFSET_FILL);
+        glPolygonOffset(2.0f, 4.0f);
 
-            shader->setMat4("model", model);
+        for (int c = 0; c < CascadedShadowMap::CascadeCount; c++) {
+            const CascadedShadowMap::Cascade& cascade = shadowMap->getCascade(c);
 
-            Mesh* meshToDraw = nullptr;
-            if (obj.type == ObjectType::Cube) meshToDraw = cubeMesh;
-            else if (obj.type == ObjectType::Sphere) meshToDraw = sphereMesh;
-            else if (obj.type == ObjectType::Capsule) meshToDraw = capsuleMesh;
-            else if (obj.type == ObjectType::OBJMesh && obj.meshId != -1) {
-                meshToDraw = g_objLoader.getMesh(obj.meshId);
+            shadowCandidates.clear();
+            sceneTree.queryBox(cascade.casterBounds, shadowCandidates);
+            shadowStaticCasters.clear();
+            shadowDynamicCasters.clear();
+            for (int index : shadowCandidates) {
+                bool isStatic = world.has<StaticTag>(world.entityAt(static_cast<size_t>(index)));
+                (isStatic ? shadowStaticCasters : shadowDynamicCasters).push_back(index);
             }
 
-            if (meshToDraw) {
-                meshToDraw->draw();
+            bool staticRedrawn = cascade.staticDirty;
+            if (staticRedrawn) {
+                shadowMap->beginStaticPass(stateCache, c);
+                drawShadowCasters(shadowStaticCasters, world, cascade.viewProjection);
+                shadowMap->endStaticPass(c);
+            }
+            if (staticRedrawn || cascade.hasDynamic || !shadowDynamicCasters.empty()) {
+                shadowMap->beginCompositePass(stateCache, c, !shadowDynamicCasters.empty());
+                drawShadowCasters(shadowDynamicCasters, world, cascade.viewProjection);
             }
         }
 
-        // Skybox last
-        if (skybox) {
-            glm::mat4 view = camera.getViewMatrix();
-            glm::mat4 proj = glm::perspective(glm::radians(FOV), 
-                                            (float)currentWidth / currentHeight, 
-                                            NEAR_PLANE, FAR_PLANE);
+        glDisable(GL_POLYGON_OFFSET_FILL);
+
+        shadowMap->fillUniforms(uniforms);
+        uniforms.params = glm::vec4(1.0f, 0.0005f, 0.0f, 0.0f);
+        shadowUniforms->update(&uniforms, sizeof(uniforms));
+    }
+
+    // Depth-only instanced draws of the given objects, one per mesh
+    void drawShadowCasters(const std::vector<int>& casters, const EntityWorld& world, const glm::mat4& lightViewProjection) {
+        if (casters.empty()) return;
 
-            skybox->draw(glm::value_ptr(view), glm::value_ptr(proj));
+        // Each caster's mesh is looked up once, then the casters are grouped by it
+        shadowCasterMeshes.resize(casters.size());
+        for (size_t i = 0; i < casters.size(); i++) {
+            Entity entity = world.entityAt(static_cast<size_t>(casters[i]));
+            shadowCasterMeshes[i] = { getMesh(*world.get<MeshRef>(entity)), entity };
+        }
+        std::sort(shadowCasterMeshes.begin(), shadowCasterMeshes.end(), [](const ShadowCaster& a, const ShadowCaster& b) {
+            return std::less<const Mesh*>()(a.first, b.first);
+        });
+        shadowInstances.resize(casters.size());
+        for (size_t i = 0; i < casters.size(); i++) {
+            shadowInstances[i].model = worldMatrix(*world.get<Transform>(shadowCasterMeshes[i].second));
+            shadowInstances[i].normalMatrix = glm::mat3(1.0f);  // unused by the depth shader
+        }
+        uploadInstances(shadowInstanceVBO, shadowInstanceCapacity, shadowInstances);
+        shadowShader->setMat4(shadowMatrixLocation, lightViewProjection);
+
+        size_t first = 0;
+        while (first < casters.size()) {
+            const Mesh* mesh = shadowCasterMeshes[first].first;
+            size_t end = first + 1;
+            while (end < casters.size() && shadowCasterMeshes[end].first == mesh) end++;
+
+            stateCache.bindVertexArray(mesh->getVAO());
+            mesh->bindInstanceData(stateCache, shadowInstanceVBO, first * sizeof(InstanceData));
+            mesh->drawInstanced(static_cast<int>(end - first));
+            drawCallsThisFrame++;
+            shadowDrawsThisFrame++;
+            first = end;
         }
+    }
 
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    void queueOpaquePass(const EntityWorld& world, const AABBTree& sceneTree, const FrameUniforms& frame) {
+        PROFILE_SCOPE("Renderer::queueOpaquePass");
+        cullObjects(world, sceneTree, frame.projection * frame.view);
+        selectLods(world.size(), glm::vec3(frame.viewPos), frame.projection[1][1]);
+        buildDrawBatches();
+        uploadInstanceData();
+
+        const int textureSet = 0;
+        for (size_t b = 0; b < drawBatches.size(); b++) {
+            const DrawBatch& batch = drawBatches[b];
+            DrawItem item;
+            item.type = DrawItemType::MeshBatch;
+            item.pass = RenderPassType::Opaque;
+            item.program = shader->ID;
+            item.vertexArray = batch.mesh->getVAO();
+            item.textureSet = textureSet;
+            item.depthFunc = GL_LESS;
+            item.batch = static_cast<int>(b);
+
+            uint64_t key = RenderKey::make(static_cast<unsigned int>(RenderPassType::Opaque), MainShaderKey,
+                                           textureSet, item.vertexArray, batch.nearestDistance / FAR_PLANE);
+            renderQueue.push(key, static_cast<uint32_t>(drawItems.size()));
+            drawItems.push_back(item);
+        }
     }
 
-    void endRender() {
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    void queueSkybox() {
+        DrawItem item;
+        item.type = DrawItemType::Skybox;
+        item.pass = RenderPassType::Skybox;
+        item.depthFunc = GL_LEQUAL;
+
+        uint64_t key = RenderKey::make(static_cast<unsigned int>(RenderPassType::Skybox), SkyboxShaderKey, 0, 0, 1.0f);
+        renderQueue.push(key, static_cast<uint32_t>(drawItems.size()));
+        drawItems.push_back(item);
     }
 
-    unsigned int getViewportTexture() const { return viewportTexture; }
+    const char* getPassName(RenderPassType type) const {
+        for (const RenderPass& pass : framePasses) {
+            if (pass.type == type) return pass.name;
+        }
+        return "Unknown";
+    }
 
-private:
-    void setupFBO() {
-        glGenFramebuffers(1, &framebuffer);
-        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    void submitQueue() {
+        PROFILE_SCOPE("Renderer::submitQueue");
+        // The queue is sorted by pass first, so each pass is one contiguous profiler scope
+        int passScope = -1;
+        bool inPass = false;
+        RenderPassType currentPass = RenderPassType::Opaque;
+
+        for (const RenderCommand& command : renderQueue.getCommands()) {
+            const DrawItem& item = drawItems[command.payload];
+            if (gpuProfiler && (!inPass || item.pass != currentPass)) {
+                if (inPass) gpuProfiler->endScope(passScope);
+                passScope = gpuProfiler->beginScope(getPassName(item.pass));
+                currentPass = item.pass;
+                inPass = true;
+            }
+            stateCache.setDepthFunc(item.depthFunc);
+
+            switch (item.type) {
+                case DrawItemType::MeshBatch: {
+                    const DrawBatch& batch = drawBatches[item.batch];
+                    stateCache.useProgram(item.program);
+                    const TextureSet& textures = textureSets[item.textureSet];
+                    stateCache.bindTexture(0, GL_TEXTURE_2D, textures.textures[0]);
+                    stateCache.bindTexture(1, GL_TEXTURE_2D, textures.textures[1]);
+                    lightDataBuffer->bind(stateCache, LightDataUnit);
+                    clusterGridBuffer->bind(stateCache, ClusterGridUnit);
+                    lightIndexBuffer->bind(stateCache, LightIndexUnit);
+                    stateCache.bindTexture(ShadowMapUnit, GL_TEXTURE_2D_ARRAY, shadowMap->getTexture());
+                    stateCache.bindVertexArray(item.vertexArray);
+
+                    batch.mesh->bindInstanceData(stateCache, instanceVBO, batch.first * sizeof(InstanceData));
+                    batch.mesh->drawInstanced(static_cast<int>(batch.count), batch.lod);
+                    drawCallsThisFrame++;
+                    trianglesThisFrame += batch.mesh->getLod(batch.lod).indexCount / 3 * static_cast<int>(batch.count);
+                    break;
+                }
+                case DrawItemType::Skybox:
+                    skybox->draw(stateCache);
+                    drawCallsThisFrame++;
+                    break;
+            }
+        }
+        if (inPass) gpuProfiler->endScope(passScope);
+    }
+
+    // Coarse pass through the scene tree (whole subtrees are accepted or rejected by
+    // their fat boxes), then the SIMD kernel on the candidates' exact world boxes.
+    void cullObjects(const EntityWorld& world, const AABBTree& sceneTree, const glm::mat4& viewProj) {
+        Frustum frustum = Frustum::fromMatrix(viewProj);
+
+        cullCandidates.clear();
+        sceneTree.queryFrustum(frustum, cullCandidates);
+
+        candidateModels.resize(cullCandidates.size());
+        candidateMeshes.resize(cullCandidates.size());
+        cullBoxes.resize(cullCandidates.size());
+        parallelFor(jobs, cullCandidates.size(), RENDER_PREP_GRAIN, [&](size_t begin, size_t end) {
+            for (size_t c = begin; c < end; c++) {
+                Entity entity = world.entityAt(static_cast<size_t>(cullCandidates[c]));
+                candidateMeshes[c] = getMesh(*world.get<MeshRef>(entity));
+                candidateModels[c] = worldMatrix(*world.get<Transform>(entity));
+                cullBoxes.set(c, transformAABB(candidateMeshes[c]->getBounds().box, candidateModels[c]));
+            }
+        });
+
+        cullVisible.resize(cullBoxes.size());
+        size_t visible = cullAABBs(frustum, cullBoxes, cullVisible.data());
+
+        visibleObjects.clear();
+        visibleMeshes.clear();
+        visibleModels.clear();
+        for (size_t c = 0; c < cullCandidates.size(); c++) {
+            if (!cullVisible[c]) continue;
+            visibleObjects.push_back(cullCandidates[c]);
+            visibleMeshes.push_back(candidateMeshes[c]);
+            visibleModels.push_back(candidateModels[c]);
+        }
+        visibleObjectCount = static_cast<int>(visible);
+        culledObjectCount = static_cast<int>(sceneTree.getProxyCount() - visible);
+    }
+
+    // Picks each visible object's LOD from the fraction of the viewport height its bounding
+    // sphere covers. Boundaries the object already crossed are widened by LOD_HYSTERESIS.
+    void selectLods(size_t objectCount, const glm::vec3& cameraPos, float projScaleY) {
+        objectLod.resize(objectCount, 0);
+        visibleLod.resize(visibleObjects.size());
+        visibleDistance.resize(visibleObjects.size());
+
+        // Every visible object is distinct, so the ranges write disjoint entries
+        parallelFor(jobs, visibleObjects.size(), RENDER_PREP_GRAIN, [&](size_t begin, size_t end) {
+            for (size_t v = begin; v < end; v++) {
+                int objectIndex = visibleObjects[v];
+                const Mesh* mesh = visibleMeshes[v];
+                const glm::mat4& model = visibleModels[v];
+                const BoundingSphere& sphere = mesh->getBounds().sphere;
+                float distance = glm::length(glm::vec3(model * glm::vec4(sphere.center, 1.0f)) - cameraPos);
+                visibleDistance[v] = distance;
+
+                if (mesh->getLodCount() == 1) {
+                    visibleLod[v] = 0;
+                    continue;
+                }
+
+                float maxScale = std::max(glm::length(glm::vec3(model[0])),
+                                          std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+                float radius = sphere.radius * maxScale;
+                float screenSize = distance > radius ? radius * projScaleY / distance : 1.0f;
+
+                int current = objectLod[objectIndex];
+                float baseTriangles = static_cast<float>(mesh->getLod(0).indexCount);
+                int lod = 0;
+                for (int i = 1; i < mesh->getLodCount(); i++) {
+                    float threshold = LOD_FULL_DETAIL_SCREEN_SIZE * std::sqrt(mesh->getLod(i).indexCount / baseTriangles);
+                    threshold *= i <= current ? 1.0f + LOD_HYSTERESIS : 1.0f - LOD_HYSTERESIS;
+                    if (screenSize < threshold) lod = i;
+                }
+
+                objectLod[objectIndex] = static_cast<uint8_t>(lod);
+                visibleLod[v] = lod;
+            }
+        });
+    }
+
+    // Counting sort of the visible objects by mesh and LOD: one pass sizes the batches, the
+    // second writes each object's matrices straight into its batch's slice of instanceData.
+    void buildDrawBatches() {
+        drawBatches.clear();
+        batchLookup.clear();
+        visibleBatch.resize(visibleObjects.size());
+
+        for (size_t v = 0; v < visibleObjects.size(); v++) {
+            const Mesh* mesh = visibleMeshes[v];
+            BatchKey key = { mesh, visibleLod[v] };
+            auto it = batchLookup.find(key);
+            if (it == batchLookup.end()) {
+                it = batchLookup.emplace(key, drawBatches.size()).first;
+                DrawBatch batch;
+                batch.mesh = mesh;
+                batch.lod = key.lod;
+                batch.nearestDistance = visibleDistance[v];
+                drawBatches.push_back(batch);
+            }
+            drawBatches[it->second].count++;
+            drawBatches[it->second].nearestDistance = std::min(drawBatches[it->second].nearestDistance, visibleDistance[v]);
+            visibleBatch[v] = static_cast<int>(it->second);
+        }
+
+        size_t total = 0;
+        for (DrawBatch& batch : drawBatches) {
+            batch.first = total;
+            total += batch.count;
+            batch.count = 0;
+        }
+        instanceData.resize(total);
+
+        // Slots are handed out in order; the matrices, mostly the inverse, are then filled in
+        // on the job workers
+        for (size_t v = 0; v < visibleObjects.size(); v++) {
+            DrawBatch& batch = drawBatches[visibleBatch[v]];
+            visibleBatch[v] = static_cast<int>(batch.first + batch.count++);
+        }
+        parallelFor(jobs, visibleObjects.size(), RENDER_PREP_GRAIN, [this](size_t begin, size_t end) {
+            for (size_t v = begin; v < end; v++) {
+                const glm::mat4& model = visibleModels[v];
+                InstanceData& instance = instanceData[visibleBatch[v]];
+                instance.model = model;
+                instance.normalMatrix = glm::transpose(glm::inverse(glm::mat3(model)));
+            }
+        });
+    }
 
-        glGenTextures(1, &viewportTexture);
-        glBindTexture(GL_TEXTURE_2D, viewportTexture);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, currentWidth, currentHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, viewportTexture, 0);
+    void uploadInstanceData() {
+        uploadInstances(instanceVBO, instanceCapacity, instanceData);
+    }
 
-        glGenRenderbuffers(1, &rbo);
-        glBindRenderbuffer(GL_RENDERBUFFER, rbo);
-        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, currentWidth, currentHeight);
-        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, rbo);
+    void uploadInstances(unsigned int buffer, size_t& capacity, const std::vector<InstanceData>& instances) {
+        if (instances.empty()) return;
 
-        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
-            std::cerr << "Framebuffer setup failed!\n";
+        size_t bytes = instances.size() * sizeof(InstanceData);
+        stateCache.bindArrayBuffer(buffer);
+        if (instances.size() > capacity) {
+            capacity = instances.size() + instances.size() / 2;
         }
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        // Orphan the previous storage so the upload never waits on the GPU
+        glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(InstanceData), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, instances.data());
     }
 };
 
@@ -985,6 +1902,13 @@ public:
     bool isLoaded = false;
     bool hasUnsavedChanges = false;
 
+    // Viewport rendering: GPU milliseconds the viewport may take before dynamic
+    // resolution lowers the render size
+    bool dynamicResolution = true;
+    float frameBudgetMs = DynamicResolution::DefaultBudget;
+    // Job system workers; 0 uses every hardware thread but the main one
+    int workerThreads = 0;
+
     Project() = default;
 
     Project(const std::string& projectName, const fs::path& basePath)
@@ -1032,6 +1956,12 @@ public:
                     name = line.substr(5);
                 } else if (line.find("lastScene=") == 0) {
                     currentSceneName = line.substr(10);
+                } else if (line.find("dynamicResolution=") == 0) {
+                    dynamicResolution = std::stoi(line.substr(18)) != 0;
+                } else if (line.find("frameBudget=") == 0) {
+                    frameBudgetMs = std::stof(line.substr(12));
+                } else if (line.find("workerThreads=") == 0) {
+                    workerThreads = std::max(0, std::stoi(line.substr(14)));
                 }
             }
             file.close();
@@ -1052,6 +1982,9 @@ public:
         std::ofstream file(projectPath / "project.modu");
         file << "name=" << name << "\n";
         file << "lastScene=" << currentSceneName << "\n";
+        file << "dynamicResolution=" << (dynamicResolution ? 1 : 0) << "\n";
+        file << "frameBudget=" << frameBudgetMs << "\n";
+        file << "workerThreads=" << workerThreads << "\n";
         file.close();
     }
 
@@ -1196,37 +2129,51 @@ public:
 class SceneSerializer {
 public:
     static bool saveScene(const fs::path& filePath,
-                         const std::vector<SceneObject>& objects,
+                         const SceneObjectStore& objects,
                          int nextId) {
+        PROFILE_SCOPE("SceneSerializer::saveScene");
         try {
             std::ofstream file(filePath);
             if (!file.is_open()) return false;
 
             file << "# Scene File\n";
-            file << "version=2\n";  // Bumped version for new format
+            file << "version=3\n";  // 3: transforms are relative to the parent
             file << "nextId=" << nextId << "\n";
             file << "objectCount=" << objects.size() << "\n";
             file << "\n";
 
-            for (const auto& obj : objects) {
+            for (size_t index = 0; index < objects.size(); index++) {
+                Entity entity = objects.entityAt(index);
+                const ObjectInfo& info = *objects.get<ObjectInfo>(entity);
+                const Transform& transform = *objects.get<Transform>(entity);
                 file << "[Object]\n";
-                file << "id=" << obj.id << "\n";
-                file << "name=" << obj.name << "\n";
-                file << "type=" << static_cast<int>(obj.type) << "\n";
-                file << "parentId=" << obj.parentId << "\n";
-                file << "position=" << obj.position.x << "," << obj.position.y << "," << obj.position.z << "\n";
-                file << "rotation=" << obj.rotation.x << "," << obj.rotation.y << "," << obj.rotation.z << "\n";
-                file << "scale=" << obj.scale.x << "," << obj.scale.y << "," << obj.scale.z << "\n";
+                file << "id=" << info.id << "\n";
+                file << "name=" << info.name << "\n";
+                file << "type=" << static_cast<int>(info.type) << "\n";
+                file << "parentId=" << objects.getParentId(entity) << "\n";
+                file << "static=" << (objects.getWorld().has<StaticTag>(entity) ? 1 : 0) << "\n";
+                file << "position=" << transform.position.x << "," << transform.position.y << "," << transform.position.z << "\n";
+                file << "rotation=" << transform.rotation.x << "," << transform.rotation.y << "," << transform.rotation.z << "\n";
+                file << "scale=" << transform.scale.x << "," << transform.scale.y << "," << transform.scale.z << "\n";
                 
                 // Save mesh path for OBJ meshes
-                if (obj.type == ObjectType::OBJMesh && !obj.meshPath.empty()) {
-                    file << "meshPath=" << obj.meshPath << "\n";
+                const MeshFile* meshFile = objects.get<MeshFile>(entity);
+                if (meshFile && !meshFile->path.empty()) {
+                    file << "meshPath=" << meshFile->path << "\n";
                 }
 
+                if (const Light* light = objects.get<Light>(entity)) {
+                    file << "lightColor=" << light->color.r << "," << light->color.g << "," << light->color.b << "\n";
+                    file << "lightIntensity=" << light->intensity << "\n";
+                    file << "lightRange=" << light->range << "\n";
+                    file << "spotAngles=" << light->spotInnerAngle << "," << light->spotOuterAngle << "\n";
+                }
+
+                const std::vector<int>& childIds = objects.getChildIds(entity);
                 file << "children=";
-                for (size_t i = 0; i < obj.childIds.size(); i++) {
+                for (size_t i = 0; i < childIds.size(); i++) {
                     if (i > 0) file << ",";
-                    file << obj.childIds[i];
+                    file << childIds[i];
                 }
                 file << "\n\n";
             }
@@ -1239,16 +2186,22 @@ public:
         }
     }
 
+    // OBJ files the scene references are parsed in parallel on the job workers
     static bool loadScene(const fs::path& filePath,
-                         std::vector<SceneObject>& objects,
-                         int& nextId) {
+                         SceneObjectStore& objects,
+                         int& nextId,
+                         JobSystem& jobs) {
+        PROFILE_SCOPE("SceneSerializer::loadScene");
         try {
             std::ifstream file(filePath);
             if (!file.is_open()) return false;
 
             objects.clear();
             std::string line;
-            SceneObject* currentObj = nullptr;
+            // Fields are collected per object and turned into entities once the meshes are loaded
+            std::vector<ObjectRecord> records;
+            ObjectRecord* currentObj = nullptr;
+            int version = 1;
 
             while (std::getline(file, line)) {
                 line.erase(0, line.find_first_not_of(" \t\r\n"));
@@ -1257,8 +2210,8 @@ public:
                 if (line.empty() || line[0] == '#') continue;
 
                 if (line == "[Object]") {
-                    objects.push_back(SceneObject("", ObjectType::Cube, 0));
-                    currentObj = &objects.back();
+                    records.emplace_back();
+                    currentObj = &records.back();
                     continue;
                 }
 
@@ -1268,58 +2221,133 @@ public:
                 std::string key = line.substr(0, eqPos);
                 std::string value = line.substr(eqPos + 1);
 
-                if (key == "nextId") {
+                if (key == "version") {
+                    version = std::stoi(value);
+                } else if (key == "nextId") {
                     nextId = std::stoi(value);
                 } else if (currentObj) {
                     if (key == "id") {
-                        currentObj->id = std::stoi(value);
+                        currentObj->info.id = std::stoi(value);
                     } else if (key == "name") {
-                        currentObj->name = value;
+                        currentObj->info.name = value;
                     } else if (key == "type") {
-                        currentObj->type = static_cast<ObjectType>(std::stoi(value));
+                        currentObj->info.type = static_cast<ObjectType>(std::stoi(value));
                     } else if (key == "parentId") {
-                        currentObj->parentId = std::stoi(value);
+                        currentObj->hierarchy.parentId = std::stoi(value);
+                    } else if (key == "static") {
+                        currentObj->isStatic = std::stoi(value) != 0;
                     } else if (key == "position") {
                         sscanf(value.c_str(), "%f,%f,%f",
-                               &currentObj->position.x,
-                               &currentObj->position.y,
-                               &currentObj->position.z);
+                               &currentObj->transform.position.x,
+                               &currentObj->transform.position.y,
+                               &currentObj->transform.position.z);
                     } else if (key == "rotation") {
                         sscanf(value.c_str(), "%f,%f,%f",
-                               &currentObj->rotation.x,
-                               &currentObj->rotation.y,
-                               &currentObj->rotation.z);
+                               &currentObj->transform.rotation.x,
+                               &currentObj->transform.rotation.y,
+                               &currentObj->transform.rotation.z);
                     } else if (key == "scale") {
                         sscanf(value.c_str(), "%f,%f,%f",
-                               &currentObj->scale.x,
-                               &currentObj->scale.y,
-                               &currentObj->scale.z);
+                               &currentObj->transform.scale.x,
+                               &currentObj->transform.scale.y,
+                               &currentObj->transform.scale.z);
                     } else if (key == "meshPath") {
-                        currentObj->meshPath = value;
-                        // Reload the mesh
-                        if (!value.empty() && currentObj->type == ObjectType::OBJMesh) {
-                            std::string err;
-                            currentObj->meshId = g_objLoader.loadOBJ(value, err);
-                        }
+                        currentObj->meshFile.path = value;
+                    } else if (key == "lightColor") {
+                        sscanf(value.c_str(), "%f,%f,%f",
+                               &currentObj->light.color.r,
+                               &currentObj->light.color.g,
+                               &currentObj->light.color.b);
+                    } else if (key == "lightIntensity") {
+                        currentObj->light.intensity = std::stof(value);
+                    } else if (key == "lightRange") {
+                        currentObj->light.range = std::stof(value);
+                    } else if (key == "spotAngles") {
+                        sscanf(value.c_str(), "%f,%f",
+                               &currentObj->light.spotInnerAngle,
+                               &currentObj->light.spotOuterAngle);
                     } else if (key == "children" && !value.empty()) {
                         std::stringstream ss(value);
                         std::string item;
                         while (std::getline(ss, item, ',')) {
                             if (!item.empty()) {
-                                currentObj->childIds.push_back(std::stoi(item));
+                                currentObj->hierarchy.childIds.push_back(std::stoi(item));
                             }
                         }
                     }
                 }
             }
-
             file.close();
+
+            std::vector<std::string> meshPaths;
+            for (const ObjectRecord& record : records) {
+                if (record.info.type == ObjectType::OBJMesh && !record.meshFile.path.empty()) {
+                    meshPaths.push_back(record.meshFile.path);
+                }
+            }
+            std::string meshErrors;
+            g_objLoader.loadOBJs(meshPaths, jobs, meshErrors);
+            if (!meshErrors.empty()) std::cerr << meshErrors;
+
+            for (ObjectRecord& record : records) addObject(objects, record);
+            if (version < 3) convertToLocalTransforms(objects);
             return true;
         } catch (const std::exception& e) {
             std::cerr << "Failed to load scene: " << e.what() << std::endl;
             return false;
         }
     }
+
+private:
+    struct ObjectRecord {
+        ObjectInfo info;
+        Transform transform;
+        Hierarchy hierarchy;
+        MeshFile meshFile;
+        Light light;
+        bool isStatic = false;
+    };
+
+    static void addObject(SceneObjectStore& objects, ObjectRecord& record) {
+        Entity entity = objects.create(record.info.id, record.info.name, record.info.type);
+        EntityWorld& world = objects.getWorld();
+        world.get<ObjectInfo>(entity)->isExpanded = record.info.isExpanded;
+        *world.get<Transform>(entity) = record.transform;
+
+        if (record.info.type == ObjectType::OBJMesh && !record.meshFile.path.empty()) {
+            // Loaded by loadScene() already; -1 if that failed
+            world.get<MeshRef>(entity)->meshId = g_objLoader.findOBJ(record.meshFile.path);
+            world.add(entity, std::move(record.meshFile));
+        }
+        if (Light* light = world.get<Light>(entity)) {
+            record.light.spot = light->spot;
+            *light = record.light;
+        }
+        if (record.isStatic) world.add(entity, StaticTag());
+        if (record.hierarchy.parentId != -1 || !record.hierarchy.childIds.empty()) {
+            world.add(entity, std::move(record.hierarchy));
+        }
+    }
+
+    // Scenes before version 3 stored every transform in world space
+    static void convertToLocalTransforms(SceneObjectStore& objects) {
+        std::vector<glm::mat4> worldMatrices;
+        worldMatrices.reserve(objects.size());
+        for (size_t i = 0; i < objects.size(); i++) {
+            const Transform& transform = *objects.get<Transform>(objects.entityAt(i));
+            worldMatrices.push_back(TransformHierarchy::compose(transform.position, transform.rotation, transform.scale));
+        }
+
+        for (size_t i = 0; i < objects.size(); i++) {
+            Entity entity = objects.entityAt(i);
+            int parentIndex = objects.indexOf(objects.getParentId(entity));
+            if (parentIndex < 0 || static_cast<size_t>(parentIndex) == i) continue;
+
+            Transform& transform = *objects.get<Transform>(entity);
+            glm::mat4 local = glm::inverse(worldMatrices[parentIndex]) * worldMatrices[i];
+            TransformHierarchy::decompose(local, transform.position, transform.rotation, transform.scale);
+        }
+    }
 };
 
 void window_size_callback(GLFWwindow* window, int width, int height) {
@@ -1330,6 +2358,8 @@ class Engine;
 
 class Engine {
 private:
+    // Worker threads for loading and render preparation; the main thread keeps GL
+    JobSystem jobs;
     Window window;
     GLFWwindow* editorWindow = nullptr;
     Renderer renderer;
@@ -1341,15 +2371,215 @@ private:
     int viewportWidth = 800;
     int viewportHeight = 600;
 
-    std::vector<SceneObject> sceneObjects;
+    SceneObjectStore sceneObjects;
     int selectedObjectId = -1;
     int nextObjectId = 0;
 
-    SceneObject* getSelectedObject() {
-        if (selectedObjectId == -1) return nullptr;
-        auto it = std::find_if(sceneObjects.begin(), sceneObjects.end(),
-            [this](const SceneObject& obj) { return obj.id == selectedObjectId; });
-        return (it != sceneObjects.end()) ? &(*it) : nullptr;
+    // The hierarchy panel's visible rows, rebuilt when the store's version or the search
+    // filter changes
+    struct HierarchyRow {
+        Entity entity;
+        int depth;
+        bool hasChildren;
+    };
+    std::vector<HierarchyRow> hierarchyRows;
+    uint64_t hierarchyRowsVersion = 0;
+    std::string hierarchyRowsFilter;
+
+    // World bounds of every drawable object, shared by viewport culling and picking.
+    // A proxy's user data is its object's index in sceneObjects.
+    AABBTree sceneTree;
+
+    // Every object's local transform and cached world matrix; a node's user data is its
+    // object's id
+    TransformHierarchy transforms;
+
+    // Bumped by every change that can alter the rendered scene; see markSceneChanged()
+    unsigned long long sceneVersion = 0;
+
+    // Everything the viewport image depends on. While it matches the last rendered frame
+    // the viewport shows that frame again instead of re-rendering.
+    struct ViewportContent {
+        glm::vec3 cameraPosition = glm::vec3(0.0f);
+        glm::vec3 cameraFront = glm::vec3(0.0f);
+        glm::vec3 cameraUp = glm::vec3(0.0f);
+        float timeOfDay = 0.0f;
+        int width = 0;
+        int height = 0;
+        unsigned long long sceneVersion = 0;
+
+        bool operator==(const ViewportContent& other) const {
+            return cameraPosition == other.cameraPosition && cameraFront == other.cameraFront &&
+                   cameraUp == other.cameraUp && timeOfDay == other.timeOfDay && width == other.width &&
+                   height == other.height && sceneVersion == other.sceneVersion;
+        }
+    };
+    ViewportContent renderedViewport;
+    bool viewportRendered = false;
+    int viewportConvergenceFrames = 0;  // renders still due on an unchanged view
+    bool viewportSettling = false;      // the viewport target hasn't reached its size yet
+
+    // Edits that only touch names or selection don't need this
+    void markSceneChanged() {
+        sceneVersion++;
+        if (projectManager.currentProject.isLoaded) {
+            projectManager.currentProject.hasUnsavedChanges = true;
+        }
+    }
+
+    // Invalid when nothing is selected
+    Entity getSelectedEntity() const {
+        return selectedObjectId == -1 ? Entity() : sceneObjects.find(selectedObjectId);
+    }
+
+    bool computeWorldBounds(Entity entity, AABB& box) const {
+        const MeshRef* meshRef = sceneObjects.get<MeshRef>(entity);
+        const Transform* transform = sceneObjects.get<Transform>(entity);
+        const Mesh* mesh = rendererInitialized && meshRef ? renderer.getMesh(*meshRef) : nullptr;
+        if (!mesh || transform->node == TransformHierarchy::NullNode) return false;
+        box = transformAABB(mesh->getBounds().box, transforms.getWorldMatrix(transform->node));
+        return true;
+    }
+
+    // Call after an object's world matrix or mesh changes
+    void updateObjectBounds(Entity entity, const glm::vec3& displacement = glm::vec3(0.0f)) {
+        EntityWorld& world = sceneObjects.getWorld();
+        SpatialProxy* proxy = world.get<SpatialProxy>(entity);
+        if (!proxy) return;
+        if (world.has<StaticTag>(entity)) renderer.invalidateStaticShadows();
+
+        AABB box;
+        if (!computeWorldBounds(entity, box)) {
+            if (proxy->node != AABBTree::NullNode) {
+                sceneTree.destroyProxy(proxy->node);
+                proxy->node = AABBTree::NullNode;
+            }
+            return;
+        }
+
+        if (proxy->node == AABBTree::NullNode) {
+            proxy->node = sceneTree.createProxy(box, world.indexOf(entity));
+        } else {
+            sceneTree.moveProxy(proxy->node, box, displacement);
+        }
+    }
+
+    // Creates the object with a transform node under its parent's, if that exists. Its
+    // bounds follow in the next updateTransforms().
+    Entity addSceneObject(int id, const std::string& name, ObjectType type, int parentId = -1) {
+        Entity entity = sceneObjects.create(id, name, type);
+        int parentNode = TransformHierarchy::NullNode;
+        if (const Transform* parent = sceneObjects.get<Transform>(sceneObjects.find(parentId))) {
+            parentNode = parent->node;
+            sceneObjects.link(id, parentId);
+        }
+        Transform& transform = *sceneObjects.get<Transform>(entity);
+        transform.node = transforms.createNode(id, transform.position, transform.rotation, transform.scale, parentNode);
+        return entity;
+    }
+
+    // Call after editing an object's position, rotation or scale
+    void syncTransform(Entity entity) {
+        const Transform& transform = *sceneObjects.get<Transform>(entity);
+        transforms.setLocal(transform.node, transform.position, transform.rotation, transform.scale);
+    }
+
+    // Recomputes the world matrices of edited subtrees and refits the bounds of every
+    // object that moved
+    void updateTransforms() {
+        PROFILE_SCOPE("Engine::updateTransforms");
+        transforms.update(&jobs);
+        for (int node : transforms.getChangedNodes()) {
+            Entity entity = sceneObjects.find(transforms.getUserData(node));
+            if (sceneObjects.getWorld().isAlive(entity)) {
+                updateObjectBounds(entity, transforms.getDisplacement(node));
+            }
+        }
+    }
+
+    // Call after sceneObjects is replaced. Rebuilds the transform hierarchy from the
+    // parent links, then every object's bounds.
+    void rebuildSpatialIndex() {
+        sceneTree.clear();
+        transforms.clear();
+        sceneVersion++;
+        renderer.invalidateStaticShadows();
+        renderer.clearObjectState();
+        EntityWorld& world = sceneObjects.getWorld();
+        world.each<Transform>([](Entity, Transform& transform) { transform.node = TransformHierarchy::NullNode; });
+        world.each<SpatialProxy>([](Entity, SpatialProxy& proxy) { proxy.node = AABBTree::NullNode; });
+
+        // Depth first from the roots so each node lands at the end of the order. Objects
+        // not reachable from a root (a missing parent or a cycle) become roots.
+        std::vector<std::pair<int, int>> pending;  // object id, parent node
+        for (int pass = 0; pass < 2; pass++) {
+            for (size_t i = 0; i < sceneObjects.size(); i++) {
+                Entity root = sceneObjects.entityAt(i);
+                if (world.get<Transform>(root)->node != TransformHierarchy::NullNode) continue;
+                Hierarchy* rootHierarchy = world.get<Hierarchy>(root);
+                if (rootHierarchy) {
+                    if (pass == 0 && world.isAlive(sceneObjects.find(rootHierarchy->parentId))) continue;
+                    rootHierarchy->parentId = -1;
+                }
+
+                pending.push_back({ world.get<ObjectInfo>(root)->id, TransformHierarchy::NullNode });
+                while (!pending.empty()) {
+                    std::pair<int, int> next = pending.back();
+                    pending.pop_back();
+                    Entity entity = sceneObjects.find(next.first);
+                    Transform* transform = world.get<Transform>(entity);
+                    if (!transform || transform->node != TransformHierarchy::NullNode) continue;
+
+                    transform->node = transforms.createNode(next.first, transform->position, transform->rotation,
+                                                            transform->scale, next.second);
+                    Hierarchy* hierarchy = world.get<Hierarchy>(entity);
+                    if (!hierarchy) continue;
+                    // Drop child links the child doesn't agree with
+                    auto& children = hierarchy->childIds;
+                    children.erase(std::remove_if(children.begin(), children.end(), [this, &next](int childId) {
+                        Entity child = sceneObjects.find(childId);
+                        return !sceneObjects.getWorld().isAlive(child) || sceneObjects.getParentId(child) != next.first;
+                    }), children.end());
+                    for (auto child = children.rbegin(); child != children.rend(); ++child) {
+                        pending.push_back({ *child, transform->node });
+                    }
+                }
+            }
+        }
+        updateTransforms();
+    }
+
+    // Nearest object under a viewport pixel, or -1. The tree narrows the ray to a few
+    // fat boxes, which are then tested exactly in front-to-back order.
+    int pickObject(const ImVec2& mousePos, const ImVec2& imageMin, const ImVec2& imageMax,
+                   const glm::mat4& view, const glm::mat4& proj) const {
+        float ndcX = (mousePos.x - imageMin.x) / (imageMax.x - imageMin.x) * 2.0f - 1.0f;
+        float ndcY = 1.0f - (mousePos.y - imageMin.y) / (imageMax.y - imageMin.y) * 2.0f;
+
+        glm::mat4 invViewProj = glm::inverse(proj * view);
+        glm::vec4 nearPoint = invViewProj * glm::vec4(ndcX, ndcY, -1.0f, 1.0f);
+        glm::vec4 farPoint = invViewProj * glm::vec4(ndcX, ndcY, 1.0f, 1.0f);
+        glm::vec3 origin = glm::vec3(nearPoint) / nearPoint.w;
+        glm::vec3 direction = glm::normalize(glm::vec3(farPoint) / farPoint.w - origin);
+        glm::vec3 invDir = 1.0f / direction;
+
+        std::vector<RayHit> hits;
+        sceneTree.queryRay(origin, direction, FAR_PLANE, hits);
+
+        int pickedId = -1;
+        float nearest = FAR_PLANE;
+        for (const RayHit& hit : hits) {
+            if (hit.distance > nearest) break;
+
+            Entity entity = sceneObjects.entityAt(static_cast<size_t>(hit.userData));
+            AABB box;
+            float distance = 0.0f;
+            if (computeWorldBounds(entity, box) && intersectRayAABB(origin, invDir, nearest, box, distance)) {
+                nearest = distance;
+                pickedId = sceneObjects.get<ObjectInfo>(entity)->id;
+            }
+        }
+        return pickedId;
     }
 
     static void DecomposeMatrix(const glm::mat4& matrix, glm::vec3& pos, glm::vec3& rot, glm::vec3& scale) {
@@ -1383,6 +2613,19 @@ private:
     bool showInspector = true;
     bool showFileBrowser = true;
     bool showConsole = true;
+    bool showGpuProfiler = false;
+    float traceCaptureSeconds = 10.0f;
+
+    // On-demand redraw: frames are drawn only while something is changing. Input and
+    // redraw requests keep the editor drawing for ActivitySettleSeconds, long enough for
+    // ImGui layout and hover delays to settle and for the temporal upsampler to converge.
+    static constexpr double ActivitySettleSeconds = 0.5;
+    static constexpr double UnfocusedFrameRate = 10.0;
+    static constexpr double IdleWakeSeconds = 0.25;
+    bool redrawOnDemand = true;
+    std::atomic<bool> redrawRequested{ true };
+    double lastActivityTime = 0.0;
+    double lastRedrawTime = 0.0;
     bool showProjectBrowser = true;
     bool firstFrame = true;
     std::vector<std::string> consoleLog;
@@ -1395,6 +2638,8 @@ private:
     char newSceneName[128] = "";
     char saveSceneAsName[128] = "";
     bool rendererInitialized = false;
+    GpuProfiler gpuProfiler;
+    std::vector<GpuProfiler::PassStats> gpuPassStats;
     
     bool showImportOBJDialog = false;
     std::string pendingOBJPath;
@@ -1413,6 +2658,7 @@ public:
         auto mouse_cb = [](GLFWwindow* window, double xpos, double ypos) {
             auto* engine = static_cast<Engine*>(glfwGetWindowUserPointer(window));
             if (!engine) return;
+            engine->lastActivityTime = glfwGetTime();
 
             int cursorMode = glfwGetInputMode(window, GLFW_CURSOR);
             if (!engine->viewportController.isViewportFocused() || cursorMode != GLFW_CURSOR_DISABLED) {
@@ -1423,17 +2669,65 @@ public:
         };
         glfwSetCursorPosCallback(editorWindow, mouse_cb);
 
+        // Installed before ImGui, which chains to them, so every input wakes the editor
+        glfwSetKeyCallback(editorWindow, [](GLFWwindow* window, int, int, int, int) { markActivity(window); });
+        glfwSetCharCallback(editorWindow, [](GLFWwindow* window, unsigned int) { markActivity(window); });
+        glfwSetMouseButtonCallback(editorWindow, [](GLFWwindow* window, int, int, int) { markActivity(window); });
+        glfwSetScrollCallback(editorWindow, [](GLFWwindow* window, double, double) { markActivity(window); });
+        glfwSetCursorEnterCallback(editorWindow, [](GLFWwindow* window, int) { markActivity(window); });
+        glfwSetWindowFocusCallback(editorWindow, [](GLFWwindow* window, int) { markActivity(window); });
+        glfwSetFramebufferSizeCallback(editorWindow, [](GLFWwindow* window, int, int) { markActivity(window); });
+        glfwSetWindowRefreshCallback(editorWindow, [](GLFWwindow* window) { markActivity(window); });
+
         setupImGui();
+        jobs.setMainThreadWakeup([this]() { requestRedraw(); });
         logToConsole("Engine initialized - Waiting for project selection");
         return true;
     }
     
 
+    static void markActivity(GLFWwindow* window) {
+        auto* engine = static_cast<Engine*>(glfwGetWindowUserPointer(window));
+        if (engine) engine->lastActivityTime = glfwGetTime();
+    }
+
+    // Safe to call from any thread, e.g. when a background job finishes
+    void requestRedraw() {
+        redrawRequested.store(true);
+        glfwPostEmptyEvent();
+    }
+
+    // Animations that need a frame every refresh regardless of input
+    bool isAnimating() const {
+        return cursorLocked || (showGpuProfiler && !showLauncher) || viewportConvergenceFrames > 0 || viewportSettling;
+    }
+
+    // Blocks until there is a reason to draw. Events that arrive meanwhile are queued
+    // for ImGui as usual. While unfocused, frames are also spaced at least
+    // 1 / UnfocusedFrameRate apart.
+    void waitForNextFrame() {
+        PROFILE_SCOPE("Engine::idle");
+        while (!glfwWindowShouldClose(editorWindow)) {
+            if (redrawRequested.exchange(false)) lastActivityTime = glfwGetTime();
+
+            double now = glfwGetTime();
+            bool focused = glfwGetWindowAttrib(editorWindow, GLFW_FOCUSED) != 0;
+            double nextAllowed = focused ? now : lastRedrawTime + 1.0 / UnfocusedFrameRate;
+            bool wanted = !redrawOnDemand || isAnimating() || now - lastActivityTime < ActivitySettleSeconds;
+
+            if (wanted && now >= nextAllowed) break;
+            glfwWaitEventsTimeout(wanted ? nextAllowed - now : IdleWakeSeconds);
+        }
+        lastRedrawTime = glfwGetTime();
+    }
+
     bool initRenderer() {
         if (rendererInitialized) return true;
 
         try {
             renderer.initialize();
+            renderer.setGpuProfiler(&gpuProfiler);
+            renderer.setJobSystem(&jobs);
             rendererInitialized = true;
             return true;
         } catch (...) {
@@ -1442,11 +2736,16 @@ public:
     }
 
     void run() {
+        PROFILE_THREAD_NAME("Main");
         while (!glfwWindowShouldClose(editorWindow)) {
             if (glfwGetWindowAttrib(editorWindow, GLFW_ICONIFIED)) {
-                ImGui_ImplGlfw_Sleep(10);
+                glfwWaitEventsTimeout(IdleWakeSeconds);
                 continue;
             }
+            waitForNextFrame();
+            PROFILE_SCOPE("Engine::frame");
+            // Continuations of background jobs, e.g. uploading an OBJ parsed on a worker
+            jobs.runMainThreadTasks();
 
             float currentFrame = glfwGetTime();
             deltaTime = currentFrame - lastFrame;
@@ -1454,40 +2753,33 @@ public:
 
             deltaTime = std::min(deltaTime, 1.0f / 30.0f);
 
-            glfwPollEvents();
+            {
+                PROFILE_SCOPE("Engine::input");
+                glfwPollEvents();
 
-            if (!showLauncher) {
-                handleKeyboardShortcuts();
-            }
+                if (!showLauncher) {
+                    handleKeyboardShortcuts();
+                }
 
-            viewportController.update(editorWindow, cursorLocked);
+                viewportController.update(editorWindow, cursorLocked);
 
-            if (!viewportController.isViewportFocused() && cursorLocked) {
-                cursorLocked = false;
-                glfwSetInputMode(editorWindow, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
-                camera.firstMouse = true;
-            }
+                if (!viewportController.isViewportFocused() && cursorLocked) {
+                    cursorLocked = false;
+                    glfwSetInputMode(editorWindow, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
+                    camera.firstMouse = true;
+                }
 
-            if (viewportController.isViewportFocused() && cursorLocked) {
-                camera.processKeyboard(deltaTime, editorWindow);
+                if (viewportController.isViewportFocused() && cursorLocked) {
+                    camera.processKeyboard(deltaTime, editorWindow);
+                }
             }
 
+            // Queries are only issued while someone is looking at the results
+            gpuProfiler.setEnabled(showGpuProfiler && !showLauncher);
+            gpuProfiler.beginFrame();
 
-            if (!showLauncher && projectManager.currentProject.isLoaded && rendererInitialized) {
-                glm::mat4 view = camera.getViewMatrix();
-                float aspect = static_cast<float>(viewportWidth) / static_cast<float>(viewportHeight);
-                if (aspect <= 0.0f) aspect = 1.0f;
-                glm::mat4 proj = glm::perspective(glm::radians(FOV), aspect, NEAR_PLANE, FAR_PLANE);
-
-                renderer.beginRender(view, proj);
-                
-                for (const auto& obj : sceneObjects) {
-                    renderer.renderObject(obj);
-                }
-
-                renderer.renderSkybox(view, proj);
-                
-                renderer.endRender();
+            if (rendererInitialized) {
+                renderer.beginFrame();
             }
 
             ImGui_ImplOpenGL3_NewFrame();
@@ -1505,6 +2797,7 @@ public:
                     if (showInspector) renderInspectorPanel();
                     if (showFileBrowser) renderFileBrowserPanel();
                     if (showConsole) renderConsolePanel();
+                    if (showGpuProfiler) renderGpuProfilerPanel();
                     if (showProjectBrowser) renderProjectBrowserPanel();
                 }
 
@@ -1518,8 +2811,15 @@ public:
             glClearColor(0.1f, 0.1f, 0.12f, 1.00f);
             glClear(GL_COLOR_BUFFER_BIT);
 
-            ImGui::Render();
-            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+            {
+                PROFILE_SCOPE("ImGui::Render");
+                ImGui::Render();
+            }
+            {
+                PROFILE_SCOPE("ImGui_ImplOpenGL3_RenderDrawData");
+                GpuProfileScope imguiScope(&gpuProfiler, "ImGui");
+                ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+            }
 
             ImGuiIO& io = ImGui::GetIO();
             if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable) {
@@ -1529,7 +2829,12 @@ public:
                 glfwMakeContextCurrent(backup_current_context);
             }
 
-            glfwSwapBuffers(editorWindow);
+            gpuProfiler.endFrame();
+
+            {
+                PROFILE_SCOPE("glfwSwapBuffers");
+                glfwSwapBuffers(editorWindow);
+            }
             firstFrame = false;
         }
     }
@@ -1546,42 +2851,47 @@ public:
     }
 
 private:
+    // The file is parsed on a job worker; the object appears once the mesh is uploaded, as
+    // long as the same scene is still open
     void importOBJToScene(const std::string& filepath, const std::string& objectName) {
-        std::string errorMsg;
-        int meshId = g_objLoader.loadOBJ(filepath, errorMsg);
-        
-        if (meshId < 0) {
-            addConsoleMessage("Failed to load OBJ: " + errorMsg, ConsoleMessageType::Error);
-            return;
-        }
-        
-        // Create scene object
-        int id = nextObjectId++;
         std::string name = objectName.empty() ? fs::path(filepath).stem().string() : objectName;
-        
-        SceneObject obj(name, ObjectType::OBJMesh, id);
-        obj.meshPath = filepath;
-        obj.meshId = meshId;
-        
-        sceneObjects.push_back(obj);
-        selectedObjectId = id;
-        
-        if (projectManager.currentProject.isLoaded) {
-            projectManager.currentProject.hasUnsavedChanges = true;
-        }
-        
-        const auto* meshInfo = g_objLoader.getMeshInfo(meshId);
-        if (meshInfo) {
-            addConsoleMessage("Imported OBJ: " + name + " (" + 
-                            std::to_string(meshInfo->vertexCount) + " vertices, " +
-                            std::to_string(meshInfo->faceCount) + " faces)", 
-                            ConsoleMessageType::Success);
-        } else {
-            addConsoleMessage("Imported OBJ: " + name, ConsoleMessageType::Success);
-        }
+        fs::path scenePath = projectManager.currentProject.getSceneFilePath(projectManager.currentProject.currentSceneName);
+        addConsoleMessage("Importing OBJ: " + name + "...", ConsoleMessageType::Info);
+
+        g_objLoader.loadOBJAsync(filepath, jobs, [this, filepath, name, scenePath](int meshId, const std::string& errorMsg) {
+            if (meshId < 0) {
+                addConsoleMessage("Failed to load OBJ: " + errorMsg, ConsoleMessageType::Error);
+                return;
+            }
+            if (!projectManager.currentProject.isLoaded ||
+                scenePath != projectManager.currentProject.getSceneFilePath(projectManager.currentProject.currentSceneName)) {
+                addConsoleMessage("Imported OBJ: " + name + " (not added, the scene was changed)", ConsoleMessageType::Warning);
+                return;
+            }
+
+            // Create scene object
+            int id = nextObjectId++;
+            Entity entity = addSceneObject(id, name, ObjectType::OBJMesh);
+            sceneObjects.get<MeshRef>(entity)->meshId = meshId;
+            sceneObjects.getWorld().add(entity, MeshFile{ filepath });
+            selectedObjectId = id;
+            
+            markSceneChanged();
+            
+            const auto* meshInfo = g_objLoader.getMeshInfo(meshId);
+            if (meshInfo) {
+                addConsoleMessage("Imported OBJ: " + name + " (" + 
+                                std::to_string(meshInfo->vertexCount) + " vertices, " +
+                                std::to_string(meshInfo->faceCount) + " faces)", 
+                                ConsoleMessageType::Success);
+            } else {
+                addConsoleMessage("Imported OBJ: " + name, ConsoleMessageType::Success);
+            }
+        });
     }
 
     void handleKeyboardShortcuts() {
+        PROFILE_SCOPE("Engine::handleKeyboardShortcuts");
         static bool f11Pressed = false;
         if (glfwGetKey(editorWindow, GLFW_KEY_F11) == GLFW_PRESS && !f11Pressed) {
             viewportFullscreen = !viewportFullscreen;
@@ -1591,6 +2901,18 @@ private:
             f11Pressed = false;
         }
 
+#ifdef MODULARITY_PROFILING
+        // Right after a hitch: save what led up to it
+        static bool f10Pressed = false;
+        if (glfwGetKey(editorWindow, GLFW_KEY_F10) == GLFW_PRESS && !f10Pressed) {
+            captureCpuTrace();
+            f10Pressed = true;
+        }
+        if (glfwGetKey(editorWindow, GLFW_KEY_F10) == GLFW_RELEASE) {
+            f10Pressed = false;
+        }
+#endif
+
         static bool ctrlSPressed = false;
         bool ctrlDown = glfwGetKey(editorWindow, GLFW_KEY_LEFT_CONTROL) == GLFW_PRESS ||
                        glfwGetKey(editorWindow, GLFW_KEY_RIGHT_CONTROL) == GLFW_PRESS;
@@ -1632,6 +2954,30 @@ private:
         if (ImGui::IsKeyPressed(ImGuiKey_LeftCtrl)) useSnap = !useSnap;
     }
 
+    // Writes the last traceCaptureSeconds of CPU markers as Chrome trace JSON, into the
+    // project's Traces folder when a project is open
+    void captureCpuTrace() {
+        std::time_t now = std::time(nullptr);
+        char fileName[64];
+        std::strftime(fileName, sizeof(fileName), "cpu-trace-%Y%m%d-%H%M%S.json", std::localtime(&now));
+
+        fs::path tracePath = fileName;
+        if (projectManager.currentProject.isLoaded) {
+            fs::path traceDir = projectManager.currentProject.projectPath / "Traces";
+            std::error_code ec;
+            fs::create_directories(traceDir, ec);
+            tracePath = traceDir / fileName;
+        }
+
+        size_t events = 0;
+        if (CpuProfiler::writeChromeTrace(tracePath.string(), traceCaptureSeconds, &events)) {
+            addConsoleMessage("Saved CPU trace (" + std::to_string(events) + " events): " + tracePath.string(),
+                              ConsoleMessageType::Success);
+        } else {
+            addConsoleMessage("Failed to save CPU trace: " + tracePath.string(), ConsoleMessageType::Error);
+        }
+    }
+
     void OpenProjectPath(const std::string& path) {
         if (projectManager.loadProject(path)) {
             if (!initRenderer()) {
@@ -1647,6 +2993,7 @@ private:
     }
 
     void renderLauncher() {
+        PROFILE_SCOPE("Engine::renderLauncher");
         ImGuiIO& io = ImGui::GetIO();
         ImVec2 displaySize = io.DisplaySize;
 
@@ -1979,8 +3326,12 @@ private:
                 logToConsole("Error: Failed to initialize renderer!");
                 return;
             }
+            applyProjectSettings();
 
             sceneObjects.clear();
+            sceneTree.clear();
+            transforms.clear();
+            sceneVersion++;
             selectedObjectId = -1;
             nextObjectId = 0;
 
@@ -2001,14 +3352,29 @@ private:
         }
     }
 
+    // Per-project renderer settings; the renderer must be initialized
+    void applyProjectSettings() {
+        const Project& project = projectManager.currentProject;
+        renderer.setDynamicResolution(project.dynamicResolution, project.frameBudgetMs);
+        jobs.setWorkerCount(static_cast<unsigned int>(project.workerThreads));
+        sceneVersion++;
+    }
+
     void loadRecentScenes() {
+        applyProjectSettings();
         sceneObjects.clear();
+        sceneTree.clear();
+        transforms.clear();
+        sceneVersion++;
         selectedObjectId = -1;
         nextObjectId = 0;
 
         fs::path scenePath = projectManager.currentProject.getSceneFilePath(projectManager.currentProject.currentSceneName);
+        SceneObjectStore loaded;
         if (fs::exists(scenePath)) {
-            if (SceneSerializer::loadScene(scenePath, sceneObjects, nextObjectId)) {
+            if (SceneSerializer::loadScene(scenePath, loaded, nextObjectId, jobs)) {
+                sceneObjects = std::move(loaded);
+                rebuildSpatialIndex();
                 addConsoleMessage("Loaded scene: " + projectManager.currentProject.currentSceneName, ConsoleMessageType::Success);
             } else {
                 addConsoleMessage("Warning: Failed to load scene, starting fresh", ConsoleMessageType::Warning);
@@ -2044,7 +3410,12 @@ private:
         }
 
         fs::path scenePath = projectManager.currentProject.getSceneFilePath(sceneName);
-        if (SceneSerializer::loadScene(scenePath, sceneObjects, nextObjectId)) {
+        SceneObjectStore loaded;
+        int loadedNextId = 0;
+        if (SceneSerializer::loadScene(scenePath, loaded, loadedNextId, jobs)) {
+            sceneObjects = std::move(loaded);
+            nextObjectId = loadedNextId;
+            rebuildSpatialIndex();
             projectManager.currentProject.currentSceneName = sceneName;
             projectManager.currentProject.hasUnsavedChanges = false;
             projectManager.currentProject.saveProjectFile();
@@ -2063,11 +3434,14 @@ private:
         }
 
         sceneObjects.clear();
+        sceneTree.clear();
+        transforms.clear();
+        sceneVersion++;
         selectedObjectId = -1;
         nextObjectId = 0;
 
         projectManager.currentProject.currentSceneName = sceneName;
-        projectManager.currentProject.hasUnsavedChanges = true;
+        markSceneChanged();
 
         addObject(ObjectType::Cube, "Cube");
 
@@ -2077,6 +3451,7 @@ private:
     }
 
     void renderDialogs() {
+        PROFILE_SCOPE("Engine::renderDialogs");
         if (showNewSceneDialog) {
             ImGuiIO& io = ImGui::GetIO();
             ImVec2 center = ImVec2(io.DisplaySize.x * 0.5f, io.DisplaySize.y * 0.5f);
@@ -2192,6 +3567,7 @@ private:
     }
 
     void renderProjectBrowserPanel() {
+        PROFILE_SCOPE("Engine::renderProjectBrowserPanel");
         ImGui::Begin("Project", &showProjectBrowser);
 
         if (!projectManager.currentProject.isLoaded) {
@@ -2280,12 +3656,11 @@ private:
                     if (ImGui::BeginPopupContextItem()) {
                         if (ImGui::MenuItem("Add to Scene")) {
                             int id = nextObjectId++;
-                            SceneObject obj(mesh.name, ObjectType::OBJMesh, id);
-                            obj.meshPath = mesh.path;
-                            obj.meshId = static_cast<int>(i);
-                            sceneObjects.push_back(obj);
+                            Entity entity = addSceneObject(id, mesh.name, ObjectType::OBJMesh);
+                            sceneObjects.get<MeshRef>(entity)->meshId = static_cast<int>(i);
+                            sceneObjects.getWorld().add(entity, MeshFile{ mesh.path });
                             selectedObjectId = id;
-                            projectManager.currentProject.hasUnsavedChanges = true;
+                            markSceneChanged();
                             addConsoleMessage("Added mesh instance: " + mesh.name, ConsoleMessageType::Info);
                         }
                         ImGui::EndPopup();
@@ -2422,6 +3797,7 @@ private:
     }
 
     void setupDockspace() {
+        PROFILE_SCOPE("Engine::setupDockspace");
         ImGuiWindowFlags window_flags = ImGuiWindowFlags_MenuBar | ImGuiWindowFlags_NoDocking;
 
         const ImGuiViewport* viewport = ImGui::GetMainViewport();
@@ -2459,6 +3835,7 @@ private:
             ImGui::DockBuilderDockWindow("Viewport", dock_main_id);
             ImGui::DockBuilderDockWindow("Inspector", dock_right);
             ImGui::DockBuilderDockWindow("Console", dock_bottom);
+            ImGui::DockBuilderDockWindow("GPU Profiler", dock_bottom);
 
             ImGui::DockBuilderFinish(dockspace_id);
         }
@@ -2467,6 +3844,7 @@ private:
     }
 
     void renderMainMenuBar() {
+        PROFILE_SCOPE("Engine::renderMainMenuBar");
         if (ImGui::BeginMainMenuBar()) {
             if (ImGui::BeginMenu("File")) {
                 if (ImGui::MenuItem("New Scene", "Ctrl+N")) {
@@ -2488,6 +3866,9 @@ private:
                     }
                     projectManager.currentProject = Project();
                     sceneObjects.clear();
+                    sceneTree.clear();
+                    transforms.clear();
+                    sceneVersion++;
                     selectedObjectId = -1;
                     showLauncher = true;
                     addConsoleMessage("Closed project", ConsoleMessageType::Info);
@@ -2524,6 +3905,11 @@ private:
                     }
                     ImGui::EndMenu();
                 }
+                if (ImGui::BeginMenu("Light")) {
+                    if (ImGui::MenuItem("Point Light")) addObject(ObjectType::PointLight, "Point Light");
+                    if (ImGui::MenuItem("Spot Light")) addObject(ObjectType::SpotLight, "Spot Light");
+                    ImGui::EndMenu();
+                }
                 ImGui::EndMenu();
             }
             
@@ -2534,11 +3920,24 @@ private:
                 ImGui::MenuItem("File Browser", nullptr, &showFileBrowser);
                 ImGui::MenuItem("Project", nullptr, &showProjectBrowser);
                 ImGui::MenuItem("Console", nullptr, &showConsole);
+                ImGui::MenuItem("GPU Profiler", nullptr, &showGpuProfiler);
                 ImGui::Separator();
+                ImGui::MenuItem("Redraw On Demand", nullptr, &redrawOnDemand);
                 if (ImGui::MenuItem("Fullscreen Viewport", "F11", &viewportFullscreen)) {}
                 ImGui::EndMenu();
             }
 
+#ifdef MODULARITY_PROFILING
+            if (ImGui::BeginMenu("Profile")) {
+                if (ImGui::MenuItem("Capture CPU Trace", "F10")) {
+                    captureCpuTrace();
+                }
+                ImGui::SetNextItemWidth(120.0f);
+                ImGui::SliderFloat("Trace Length", &traceCaptureSeconds, 1.0f, 30.0f, "%.0f s");
+                ImGui::EndMenu();
+            }
+#endif
+
             if (ImGui::BeginMenu("Help")) {
                 if (ImGui::MenuItem("About")) {
                     addConsoleMessage("Modularity - V1.0.1", ConsoleMessageType::Info);
@@ -2554,6 +3953,7 @@ private:
     }
 
     void renderHierarchyPanel() {
+        PROFILE_SCOPE("Engine::renderHierarchyPanel");
         ImGui::Begin("Hierarchy", &showHierarchy);
 
         static char searchBuffer[128] = "";
@@ -2574,12 +3974,19 @@ private:
 
         std::string filter = searchBuffer;
         std::transform(filter.begin(), filter.end(), filter.begin(), ::tolower);
+        if (sceneObjects.getVersion() != hierarchyRowsVersion || filter != hierarchyRowsFilter) {
+            rebuildHierarchyRows(filter);
+        }
 
-        for (size_t i = 0; i < sceneObjects.size(); i++) {
-            if (sceneObjects[i].parentId != -1) continue;
-
-            renderObjectNode(sceneObjects[i], filter);
+        // Only the rows in view are submitted
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(hierarchyRows.size()));
+        while (clipper.Step()) {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+                renderHierarchyRow(hierarchyRows[row]);
+            }
         }
+        clipper.End();
 
         ImGui::EndChild();
 
@@ -2588,6 +3995,9 @@ private:
                 if (ImGui::MenuItem("Cube")) addObject(ObjectType::Cube, "Cube");
                 if (ImGui::MenuItem("Sphere")) addObject(ObjectType::Sphere, "Sphere");
                 if (ImGui::MenuItem("Capsule")) addObject(ObjectType::Capsule, "Capsule");
+                ImGui::Separator();
+                if (ImGui::MenuItem("Point Light")) addObject(ObjectType::PointLight, "Point Light");
+                if (ImGui::MenuItem("Spot Light")) addObject(ObjectType::SpotLight, "Spot Light");
                 ImGui::EndMenu();
             }
             ImGui::EndPopup();
@@ -2596,20 +4006,53 @@ private:
         ImGui::End();
     }
 
-    void renderObjectNode(SceneObject& obj, const std::string& filter) {
-        std::string nameLower = obj.name;
-        std::transform(nameLower.begin(), nameLower.end(), nameLower.begin(), ::tolower);
+    // Flattens the expanded part of the tree, in the order it is drawn. An object whose
+    // name doesn't contain the filter is left out along with its subtree.
+    void rebuildHierarchyRows(const std::string& filter) {
+        PROFILE_SCOPE("Engine::rebuildHierarchyRows");
+        hierarchyRows.clear();
+        for (size_t i = 0; i < sceneObjects.size(); i++) {
+            Entity entity = sceneObjects.entityAt(i);
+            if (sceneObjects.getParentId(entity) == -1) appendHierarchyRows(entity, 0, filter);
+        }
+        hierarchyRowsVersion = sceneObjects.getVersion();
+        hierarchyRowsFilter = filter;
+    }
 
-        if (!filter.empty() && nameLower.find(filter) == std::string::npos) {
-            return;
+    void appendHierarchyRows(Entity entity, int depth, const std::string& filter) {
+        const ObjectInfo& obj = *sceneObjects.get<ObjectInfo>(entity);
+        if (!filter.empty()) {
+            std::string nameLower = obj.name;
+            std::transform(nameLower.begin(), nameLower.end(), nameLower.begin(), ::tolower);
+            if (nameLower.find(filter) == std::string::npos) return;
         }
 
-        bool hasChildren = !obj.childIds.empty();
+        const std::vector<int>& childIds = sceneObjects.getChildIds(entity);
+        hierarchyRows.push_back({ entity, depth, !childIds.empty() });
+        if (!obj.isExpanded) return;
+        for (int childId : childIds) {
+            Entity child = sceneObjects.find(childId);
+            if (sceneObjects.getWorld().isAlive(child)) appendHierarchyRows(child, depth + 1, filter);
+        }
+    }
+
+    // The menu actions can add, remove and move entities, so nothing is read through a
+    // component pointer after them. Rows after such an action may be stale until the next
+    // frame rebuilds them.
+    void renderHierarchyRow(const HierarchyRow& row) {
+        const ObjectInfo* info = sceneObjects.get<ObjectInfo>(row.entity);
+        if (!info) return;
+        const ObjectInfo& obj = *info;
+        const int objectId = obj.id;
+        const std::string name = obj.name;
         bool isSelected = (selectedObjectId == obj.id);
 
-        ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_SpanAvailWidth;
+        // Rows aren't nested in ImGui's tree: the cache decides what is shown, so the node
+        // only draws the arrow and reports toggles
+        ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_SpanAvailWidth |
+                                   ImGuiTreeNodeFlags_NoTreePushOnOpen;
         if (isSelected) flags |= ImGuiTreeNodeFlags_Selected;
-        if (!hasChildren) flags |= ImGuiTreeNodeFlags_Leaf;
+        if (!row.hasChildren) flags |= ImGuiTreeNodeFlags_Leaf;
 
         const char* icon = "";
         switch (obj.type) {
@@ -2617,25 +4060,33 @@ private:
             case ObjectType::Sphere: icon = "(O)"; break;
             case ObjectType::Capsule: icon = "[|]"; break;
             case ObjectType::OBJMesh: icon = "[M]"; break;  // OBJ mesh icon
+            case ObjectType::PointLight: icon = "(*)"; break;
+            case ObjectType::SpotLight: icon = "(V)"; break;
         }
 
-        bool nodeOpen = ImGui::TreeNodeEx((void*)(intptr_t)obj.id, flags, "%s %s", icon, obj.name.c_str());
+        ImGui::SetCursorPosX(ImGui::GetCursorPosX() + row.depth * ImGui::GetStyle().IndentSpacing);
+        ImGui::SetNextItemOpen(obj.isExpanded);
+        bool nodeOpen = ImGui::TreeNodeEx((void*)(intptr_t)obj.id, flags, "%s %s", icon, name.c_str());
+        if (row.hasChildren && nodeOpen != obj.isExpanded) {
+            sceneObjects.get<ObjectInfo>(row.entity)->isExpanded = nodeOpen;
+            sceneObjects.touch();
+        }
 
         if (ImGui::IsItemClicked() && !ImGui::IsItemToggledOpen()) {
-            selectedObjectId = obj.id;
+            selectedObjectId = objectId;
         }
 
         if (ImGui::BeginDragDropSource(ImGuiDragDropFlags_None)) {
-            ImGui::SetDragDropPayload("SCENE_OBJECT", &obj.id, sizeof(int));
-            ImGui::Text("Moving: %s", obj.name.c_str());
+            ImGui::SetDragDropPayload("SCENE_OBJECT", &objectId, sizeof(int));
+            ImGui::Text("Moving: %s", name.c_str());
             ImGui::EndDragDropSource();
         }
 
         if (ImGui::BeginDragDropTarget()) {
             if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload("SCENE_OBJECT")) {
                 int draggedId = *(const int*)payload->Data;
-                if (draggedId != obj.id) {
-                    setParent(draggedId, obj.id);
+                if (draggedId != objectId) {
+                    setParent(draggedId, objectId);
                 }
             }
             ImGui::EndDragDropTarget();
@@ -2643,33 +4094,23 @@ private:
 
         if (ImGui::BeginPopupContextItem()) {
             if (ImGui::MenuItem("Duplicate")) {
-                selectedObjectId = obj.id;
+                selectedObjectId = objectId;
                 duplicateSelected();
             }
             if (ImGui::MenuItem("Delete")) {
-                selectedObjectId = obj.id;
+                selectedObjectId = objectId;
                 deleteSelected();
             }
             ImGui::Separator();
-            if (ImGui::MenuItem("Clear Parent") && obj.parentId != -1) {
-                setParent(obj.id, -1);
+            if (ImGui::MenuItem("Clear Parent") && sceneObjects.getParentId(sceneObjects.find(objectId)) != -1) {
+                setParent(objectId, -1);
             }
             ImGui::EndPopup();
         }
-
-        if (nodeOpen) {
-            for (int childId : obj.childIds) {
-                auto it = std::find_if(sceneObjects.begin(), sceneObjects.end(),
-                    [childId](const SceneObject& o) { return o.id == childId; });
-                if (it != sceneObjects.end()) {
-                    renderObjectNode(*it, filter);
-                }
-            }
-            ImGui::TreePop();
-        }
     }
 
     void renderFileBrowserPanel() {
+        PROFILE_SCOPE("Engine::renderFileBrowserPanel");
         ImGui::Begin("File Browser", &showFileBrowser);
 
         if (fileBrowser.needsRefresh) {
@@ -2764,6 +4205,7 @@ private:
     }
 
     void renderInspectorPanel() {
+        PROFILE_SCOPE("Engine::renderInspectorPanel");
         ImGui::Begin("Inspector", &showInspector);
 
         if (selectedObjectId == -1) {
@@ -2772,20 +4214,20 @@ private:
             return;
         }
 
-        auto it = std::find_if(sceneObjects.begin(), sceneObjects.end(),
-            [this](const SceneObject& obj) { return obj.id == selectedObjectId; });
-
-        if (it == sceneObjects.end()) {
+        Entity entity = getSelectedEntity();
+        EntityWorld& world = sceneObjects.getWorld();
+        if (!world.isAlive(entity)) {
             ImGui::TextDisabled("Object not found");
             ImGui::End();
             return;
         }
 
-        SceneObject& obj = *it;
-
+        // Each section looks up its own components: toggling Static moves the entity
         ImGui::PushStyleColor(ImGuiCol_Header, ImVec4(0.2f, 0.4f, 0.6f, 1.0f));
 
         if (ImGui::CollapsingHeader("Object Info", ImGuiTreeNodeFlags_DefaultOpen)) {
+            ObjectInfo& obj = *world.get<ObjectInfo>(entity);
+
             char nameBuffer[128];
             strncpy(nameBuffer, obj.name.c_str(), sizeof(nameBuffer));
             nameBuffer[sizeof(nameBuffer) - 1] = '\0';
@@ -2795,17 +4237,29 @@ private:
             ImGui::SetNextItemWidth(-1);
             if (ImGui::InputText("##Name", nameBuffer, sizeof(nameBuffer))) {
                 obj.name = nameBuffer;
+                sceneObjects.touch();
                 projectManager.currentProject.hasUnsavedChanges = true;
             }
 
             ImGui::Text("Type:");
             ImGui::SameLine();
-            const char* typeNames[] = { "Cube", "Sphere", "Capsule", "OBJ Mesh" };
+            const char* typeNames[] = { "Cube", "Sphere", "Capsule", "OBJ Mesh", "Point Light", "Spot Light" };
             ImGui::TextColored(ImVec4(0.5f, 0.8f, 1.0f, 1.0f), "%s", typeNames[(int)obj.type]);
 
             ImGui::Text("ID:");
             ImGui::SameLine();
             ImGui::TextDisabled("%d", obj.id);
+
+            bool isStatic = world.has<StaticTag>(entity);
+            if (world.has<MeshRef>(entity) && ImGui::Checkbox("Static", &isStatic)) {
+                if (isStatic) {
+                    world.add(entity, StaticTag());
+                } else {
+                    world.remove<StaticTag>(entity);
+                }
+                renderer.invalidateStaticShadows();
+                markSceneChanged();
+            }
         }
 
         ImGui::PopStyleColor();
@@ -2815,12 +4269,14 @@ private:
         ImGui::PushStyleColor(ImGuiCol_Header, ImVec4(0.4f, 0.5f, 0.3f, 1.0f));
 
         if (ImGui::CollapsingHeader("Transform", ImGuiTreeNodeFlags_DefaultOpen)) {
+            Transform& transform = *world.get<Transform>(entity);
             ImGui::Indent(10.0f);
 
             ImGui::Text("Position");
             ImGui::PushItemWidth(-1);
-            if (ImGui::DragFloat3("##Position", &obj.position.x, 0.1f)) {
-                projectManager.currentProject.hasUnsavedChanges = true;
+            if (ImGui::DragFloat3("##Position", &transform.position.x, 0.1f)) {
+                syncTransform(entity);
+                markSceneChanged();
             }
             ImGui::PopItemWidth();
 
@@ -2828,8 +4284,9 @@ private:
 
             ImGui::Text("Rotation");
             ImGui::PushItemWidth(-1);
-            if (ImGui::DragFloat3("##Rotation", &obj.rotation.x, 1.0f, -360.0f, 360.0f)) {
-                projectManager.currentProject.hasUnsavedChanges = true;
+            if (ImGui::DragFloat3("##Rotation", &transform.rotation.x, 1.0f, -360.0f, 360.0f)) {
+                syncTransform(entity);
+                markSceneChanged();
             }
             ImGui::PopItemWidth();
 
@@ -2837,18 +4294,20 @@ private:
 
             ImGui::Text("Scale");
             ImGui::PushItemWidth(-1);
-            if (ImGui::DragFloat3("##Scale", &obj.scale.x, 0.05f, 0.01f, 100.0f)) {
-                projectManager.currentProject.hasUnsavedChanges = true;
+            if (ImGui::DragFloat3("##Scale", &transform.scale.x, 0.05f, 0.01f, 100.0f)) {
+                syncTransform(entity);
+                markSceneChanged();
             }
             ImGui::PopItemWidth();
 
             ImGui::Spacing();
 
             if (ImGui::Button("Reset Transform", ImVec2(-1, 0))) {
-                obj.position = glm::vec3(0.0f);
-                obj.rotation = glm::vec3(0.0f);
-                obj.scale = glm::vec3(1.0f);
-                projectManager.currentProject.hasUnsavedChanges = true;
+                transform.position = glm::vec3(0.0f);
+                transform.rotation = glm::vec3(0.0f);
+                transform.scale = glm::vec3(1.0f);
+                syncTransform(entity);
+                markSceneChanged();
             }
 
             ImGui::Unindent(10.0f);
@@ -2856,15 +4315,57 @@ private:
 
         ImGui::PopStyleColor();
 
+        if (Light* light = world.get<Light>(entity)) {
+            ImGui::Spacing();
+            ImGui::PushStyleColor(ImGuiCol_Header, ImVec4(0.55f, 0.5f, 0.25f, 1.0f));
+
+            if (ImGui::CollapsingHeader("Light", ImGuiTreeNodeFlags_DefaultOpen)) {
+                ImGui::Indent(10.0f);
+                bool changed = false;
+
+                ImGui::Text("Color");
+                ImGui::PushItemWidth(-1);
+                changed |= ImGui::ColorEdit3("##LightColor", &light->color.x);
+                ImGui::PopItemWidth();
+
+                ImGui::Text("Intensity");
+                ImGui::PushItemWidth(-1);
+                changed |= ImGui::DragFloat("##LightIntensity", &light->intensity, 0.1f, 0.0f, 1000.0f);
+                ImGui::PopItemWidth();
+
+                ImGui::Text("Range");
+                ImGui::PushItemWidth(-1);
+                changed |= ImGui::DragFloat("##LightRange", &light->range, 0.1f, 0.1f, 500.0f);
+                ImGui::PopItemWidth();
+
+                if (light->spot) {
+                    ImGui::Text("Inner / Outer Angle");
+                    ImGui::PushItemWidth(-1);
+                    if (ImGui::DragFloatRange2("##SpotAngles", &light->spotInnerAngle, &light->spotOuterAngle, 0.5f, 0.0f, 89.0f, "%.1f", "%.1f")) {
+                        changed = true;
+                    }
+                    ImGui::PopItemWidth();
+                }
+
+                if (changed) markSceneChanged();
+                ImGui::Unindent(10.0f);
+            }
+
+            ImGui::PopStyleColor();
+        }
+
         // OBJ Mesh info section
-        if (obj.type == ObjectType::OBJMesh) {
+        MeshRef* meshRef = world.get<MeshRef>(entity);
+        if (meshRef && meshRef->type == ObjectType::OBJMesh) {
+            const MeshFile* meshFile = world.get<MeshFile>(entity);
+            std::string meshPath = meshFile ? meshFile->path : std::string();
             ImGui::Spacing();
             ImGui::PushStyleColor(ImGuiCol_Header, ImVec4(0.3f, 0.5f, 0.4f, 1.0f));
             
             if (ImGui::CollapsingHeader("Mesh Info", ImGuiTreeNodeFlags_DefaultOpen)) {
                 ImGui::Indent(10.0f);
                 
-                const auto* meshInfo = g_objLoader.getMeshInfo(obj.meshId);
+                const auto* meshInfo = g_objLoader.getMeshInfo(meshRef->meshId);
                 if (meshInfo) {
                     ImGui::Text("Source File:");
                     ImGui::TextDisabled("%s", fs::path(meshInfo->path).filename().string().c_str());
@@ -2872,30 +4373,46 @@ private:
                     ImGui::Spacing();
                     
                     ImGui::Text("Vertices: %d", meshInfo->vertexCount);
+                    ImGui::Text("Indices: %d", meshInfo->indexCount);
+                    if (meshInfo->mesh) {
+                        ImGui::Text("Vertex Size: %d bytes", static_cast<int>(meshInfo->mesh->getLayout().stride));
+                    }
                     ImGui::Text("Faces: %d", meshInfo->faceCount);
                     ImGui::Text("Has Normals: %s", meshInfo->hasNormals ? "Yes" : "No");
                     ImGui::Text("Has UVs: %s", meshInfo->hasTexCoords ? "Yes" : "No");
+
+                    if (meshInfo->mesh) {
+                        ImGui::Spacing();
+                        ImGui::Text("Levels of Detail:");
+                        for (int lod = 0; lod < meshInfo->mesh->getLodCount(); lod++) {
+                            ImGui::BulletText("LOD %d: %d triangles", lod, meshInfo->mesh->getLod(lod).indexCount / 3);
+                        }
+                    }
                     
                     ImGui::Spacing();
                     
                     if (ImGui::Button("Reload Mesh", ImVec2(-1, 0))) {
                         std::string errMsg;
-                        int newId = g_objLoader.loadOBJ(obj.meshPath, errMsg);
+                        int newId = g_objLoader.loadOBJ(meshPath, errMsg);
                         if (newId >= 0) {
-                            obj.meshId = newId;
-                            addConsoleMessage("Reloaded mesh: " + obj.name, ConsoleMessageType::Success);
+                            meshRef->meshId = newId;
+                            updateObjectBounds(entity);
+                            sceneVersion++;
+                            addConsoleMessage("Reloaded mesh: " + world.get<ObjectInfo>(entity)->name, ConsoleMessageType::Success);
                         } else {
                             addConsoleMessage("Failed to reload: " + errMsg, ConsoleMessageType::Error);
                         }
                     }
                 } else {
                     ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "Mesh data not found!");
-                    ImGui::TextDisabled("Path: %s", obj.meshPath.c_str());
+                    ImGui::TextDisabled("Path: %s", meshPath.c_str());
                     
                     if (ImGui::Button("Try Reload", ImVec2(-1, 0))) {
                         std::string errMsg;
-                        obj.meshId = g_objLoader.loadOBJ(obj.meshPath, errMsg);
-                        if (obj.meshId >= 0) {
+                        meshRef->meshId = g_objLoader.loadOBJ(meshPath, errMsg);
+                        updateObjectBounds(entity);
+                        sceneVersion++;
+                        if (meshRef->meshId >= 0) {
                             addConsoleMessage("Mesh reloaded successfully", ConsoleMessageType::Success);
                         } else {
                             addConsoleMessage("Reload failed: " + errMsg, ConsoleMessageType::Error);
@@ -2922,10 +4439,20 @@ private:
                 ImGui::Text("Time of Day");
                 ImGui::PushItemWidth(-1);
                 if (ImGui::SliderFloat("##TimeOfDay", &timeOfDay, 0.0f, 1.0f, "%.2f")) {
+                    renderer.getSkybox()->setTimeOfDay(timeOfDay, true);
+                }
+                // Releasing the slider brings the sky back to full bake resolution
+                if (ImGui::IsItemDeactivatedAfterEdit()) {
                     renderer.getSkybox()->setTimeOfDay(timeOfDay);
+                    sceneVersion++;
                 }
                 ImGui::PopItemWidth();
 
+                bool preview = renderer.getSkybox()->getPreviewWhileEditing();
+                if (ImGui::Checkbox("Low-res preview while dragging", &preview)) {
+                    renderer.getSkybox()->setPreviewWhileEditing(preview);
+                }
+
                 if (ImGui::Button("Night", ImVec2(60, 0))) renderer.getSkybox()->setTimeOfDay(0.0f);
                 ImGui::SameLine();
                 if (ImGui::Button("Sunrise", ImVec2(60, 0))) renderer.getSkybox()->setTimeOfDay(0.25f);
@@ -2940,6 +4467,44 @@ private:
             ImGui::PopStyleColor();
         }
 
+        ImGui::Spacing();
+
+        ImGui::PushStyleColor(ImGuiCol_Header, ImVec4(0.3f, 0.4f, 0.3f, 1.0f));
+
+        if (rendererInitialized && ImGui::CollapsingHeader("Rendering")) {
+            ImGui::Indent(10.0f);
+
+            Project& project = projectManager.currentProject;
+            bool changed = ImGui::Checkbox("Dynamic Resolution", &project.dynamicResolution);
+
+            ImGui::BeginDisabled(!project.dynamicResolution);
+            ImGui::Text("GPU Budget (ms)");
+            ImGui::PushItemWidth(-1);
+            changed |= ImGui::SliderFloat("##FrameBudget", &project.frameBudgetMs, 4.0f, 50.0f, "%.1f ms");
+            ImGui::PopItemWidth();
+            ImGui::EndDisabled();
+
+            ImGui::TextDisabled("Rendering at %dx%d (%.0f%%)", renderer.getRenderWidth(), renderer.getRenderHeight(),
+                                renderer.getResolutionScale() * 100.0f);
+
+            // The pool restarts on release rather than at every step of the drag
+            ImGui::Text("Worker Threads");
+            ImGui::PushItemWidth(-1);
+            ImGui::SliderInt("##WorkerThreads", &project.workerThreads, 0, 32, project.workerThreads == 0 ? "Auto" : "%d");
+            ImGui::PopItemWidth();
+            changed |= ImGui::IsItemDeactivatedAfterEdit();
+            ImGui::TextDisabled("%u job workers besides the main thread", jobs.getWorkerCount());
+
+            if (changed) {
+                applyProjectSettings();
+                project.hasUnsavedChanges = true;
+            }
+
+            ImGui::Unindent(10.0f);
+        }
+
+        ImGui::PopStyleColor();
+
         ImGui::Spacing();
         ImGui::Separator();
         ImGui::Spacing();
@@ -2958,7 +4523,72 @@ private:
         ImGui::End();
     }
 
+    void renderGpuProfilerPanel() {
+        PROFILE_SCOPE("Engine::renderGpuProfilerPanel");
+        ImGui::Begin("GPU Profiler", &showGpuProfiler);
+
+        const std::vector<GpuProfiler::PassHistory>& passes = gpuProfiler.getPasses();
+        if (passes.empty()) {
+            ImGui::TextDisabled("Waiting for GPU timings...");
+            ImGui::End();
+            return;
+        }
+
+        ImGui::TextDisabled("Last %d frames, read back %d frames late | Dropped: %d",
+                            passes[0].count, GpuProfiler::FrameLatency, gpuProfiler.getDroppedFrameCount());
+
+        gpuPassStats.resize(passes.size());
+        for (size_t i = 0; i < passes.size(); i++) gpuPassStats[i] = gpuProfiler.computeStats(passes[i]);
+
+        if (ImGui::BeginTable("GpuPasses", 6, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_SizingStretchProp)) {
+            ImGui::TableSetupColumn("Pass");
+            ImGui::TableSetupColumn("Last");
+            ImGui::TableSetupColumn("Avg");
+            ImGui::TableSetupColumn("P50");
+            ImGui::TableSetupColumn("P95");
+            ImGui::TableSetupColumn("P99");
+            ImGui::TableHeadersRow();
+
+            for (size_t i = 0; i < passes.size(); i++) {
+                const GpuProfiler::PassHistory& pass = passes[i];
+                const GpuProfiler::PassStats& stats = gpuPassStats[i];
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(pass.name.c_str());
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f ms", pass.latest);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", stats.average);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", stats.p50);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", stats.p95);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", stats.p99);
+            }
+            ImGui::EndTable();
+        }
+
+        ImGui::Spacing();
+
+        // One rolling graph per pass, each scaled to its own worst frame
+        for (size_t i = 0; i < passes.size(); i++) {
+            const GpuProfiler::PassHistory& pass = passes[i];
+            int offset = pass.count == GpuProfiler::HistoryLength ? pass.next : 0;
+
+            char overlay[64];
+            std::snprintf(overlay, sizeof(overlay), "%s  %.3f ms", pass.name.c_str(), pass.latest);
+            ImGui::PushID(static_cast<int>(i));
+            ImGui::PlotLines("##PassGraph", pass.samples, pass.count, offset, overlay, 0.0f,
+                             std::max(gpuPassStats[i].max * 1.1f, 0.01f), ImVec2(-1, 40));
+            ImGui::PopID();
+        }
+
+        ImGui::End();
+    }
+
     void renderConsolePanel() {
+        PROFILE_SCOPE("Engine::renderConsolePanel");
         ImGui::Begin("Console", &showConsole);
 
         if (ImGui::Button("Clear")) {
@@ -2993,6 +4623,7 @@ private:
     }
 
     void renderViewport() {
+        PROFILE_SCOPE("Engine::renderViewport");
         ImGuiWindowFlags viewportFlags = ImGuiWindowFlags_NoScrollWithMouse | ImGuiWindowFlags_NoScrollbar;
 
         if (viewportFullscreen) {
@@ -3034,12 +4665,35 @@ private:
 
             glm::mat4 view = camera.getViewMatrix();
 
-            renderer.beginRender(view, proj);
-            renderer.renderScene(camera, sceneObjects);
+            updateTransforms();
+
+            ViewportContent content;
+            content.cameraPosition = camera.position;
+            content.cameraFront = camera.front;
+            content.cameraUp = camera.up;
+            content.timeOfDay = renderer.getSkybox() ? renderer.getSkybox()->getTimeOfDay() : 0.0f;
+            content.width = viewportWidth;
+            content.height = viewportHeight;
+            content.sceneVersion = sceneVersion;
+
+            if (!viewportRendered || !(content == renderedViewport)) {
+                viewportConvergenceFrames = renderer.getConvergenceFrames();
+                renderer.renderScene(camera, sceneObjects.getWorld(), sceneTree, transforms);
+                renderedViewport = content;
+                viewportRendered = true;
+            } else if (viewportConvergenceFrames > 0 || viewportSettling) {
+                if (viewportConvergenceFrames > 0) viewportConvergenceFrames--;
+                renderer.renderScene(camera, sceneObjects.getWorld(), sceneTree, transforms);
+            }
+            // A resize only gets the right-sized target after a few renders at the new size;
+            // until then the image is the old target's, stretched
+            viewportSettling = !renderer.isViewportSettled();
             unsigned int tex = renderer.getViewportTexture();
+            glm::vec2 uvScale = renderer.getViewportUVScale();
 
             // DRAW THE VIEWPORT IMAGE (only top region, below we keep space for toolbar)
-            ImGui::Image((void*)(intptr_t)tex, imageSize, ImVec2(0, 1), ImVec2(1, 0));
+            // The pooled target is larger than the image; flip V and show the used corner
+            ImGui::Image((void*)(intptr_t)tex, imageSize, ImVec2(0, uvScale.y), ImVec2(uvScale.x, 0));
 
             // Get the exact rect of the image we just drew
             ImVec2 imageMin = ImGui::GetItemRectMin();
@@ -3047,8 +4701,8 @@ private:
             mouseOverViewportImage = ImGui::IsItemHovered();
 
             // GIZMO (Please work...)
-            SceneObject* selectedObj = getSelectedObject();
-            if (selectedObj) {
+            Transform* selectedTransform = sceneObjects.get<Transform>(getSelectedEntity());
+            if (selectedTransform) {
                 ImGuizmo::BeginFrame();
                 ImGuizmo::Enable(true);
                 ImGuizmo::SetOrthographic(false);
@@ -3061,13 +4715,7 @@ private:
                     imageMax.y - imageMin.y
                 );
 
-                // Build model matrix from your SceneObject
-                glm::mat4 modelMatrix(1.0f);
-                modelMatrix = glm::translate(modelMatrix, selectedObj->position);
-                modelMatrix = glm::rotate(modelMatrix, glm::radians(selectedObj->rotation.x), glm::vec3(1, 0, 0));
-                modelMatrix = glm::rotate(modelMatrix, glm::radians(selectedObj->rotation.y), glm::vec3(0, 1, 0));
-                modelMatrix = glm::rotate(modelMatrix, glm::radians(selectedObj->rotation.z), glm::vec3(0, 0, 1));
-                modelMatrix = glm::scale(modelMatrix, selectedObj->scale);
+                glm::mat4 modelMatrix = transforms.getWorldMatrix(selectedTransform->node);
 
                 float* snapPtr = nullptr;
                 float snapRot[3] = { rotationSnapValue, rotationSnapValue, rotationSnapValue };
@@ -3091,16 +4739,14 @@ private:
                 );
 
                 if (ImGuizmo::IsUsing()) {
-                    // Use ImGuizmo's own decompose helper to be safe
-                    float t[3], r[3], s[3];
-                    ImGuizmo::DecomposeMatrixToComponents(glm::value_ptr(modelMatrix), t, r, s);
-
-                    selectedObj->position = glm::vec3(t[0], t[1], t[2]);
-                    // r[] is already in degrees
-                    selectedObj->rotation = glm::vec3(r[0], r[1], r[2]);
-                    selectedObj->scale    = glm::vec3(s[0], s[1], s[2]);
-
-                    projectManager.currentProject.hasUnsavedChanges = true;
+                    // The gizmo works in world space; the object stores its transform
+                    // relative to its parent
+                    glm::mat4 local = glm::inverse(transforms.getParentWorldMatrix(selectedTransform->node)) * modelMatrix;
+                    TransformHierarchy::decompose(local, selectedTransform->position, selectedTransform->rotation,
+                                                  selectedTransform->scale);
+                    syncTransform(getSelectedEntity());
+
+                    markSceneChanged();
                 }
             }
 
@@ -3146,8 +4792,16 @@ private:
             ImGui::PopStyleColor(2);
             ImGui::PopStyleVar();
 
-            // CAMERA FOCUS CLICK (only when not dragging gizmo and ONLY over the image)
+            // ALT+CLICK selects the object under the cursor instead of grabbing the camera
             if (mouseOverViewportImage &&
+                ImGui::IsMouseClicked(ImGuiMouseButton_Left) &&
+                ImGui::GetIO().KeyAlt &&
+                !ImGuizmo::IsUsing())
+            {
+                selectedObjectId = pickObject(ImGui::GetMousePos(), imageMin, imageMax, view, proj);
+            }
+            // CAMERA FOCUS CLICK (only when not dragging gizmo and ONLY over the image)
+            else if (mouseOverViewportImage &&
                 ImGui::IsMouseClicked(ImGuiMouseButton_Left) &&
                 !ImGuizmo::IsUsing())
             {
@@ -3166,17 +4820,40 @@ private:
             }
         }
 
-        // OVERLAY HINT TEXT (top-left over the image)
+        // OVERLAY HINT TEXT (top-left over the image), one line under the other
         ImGui::SetCursorPos(ImVec2(10, 30));
+        ImGui::BeginGroup();
         ImGui::TextColored(
             ImVec4(1, 1, 1, 0.7f),
-            "WASD: Move | QE: Up/Down | Shift: Sprint | ESC: Release | F11: Fullscreen"
+            "WASD: Move | QE: Up/Down | Shift: Sprint | Alt+Click: Select | ESC: Release | F11: Fullscreen"
         );
 
+        if (rendererInitialized) {
+            ImGui::TextColored(
+                ImVec4(1, 1, 1, 0.7f),
+                "Visible: %d | Culled: %d | Draw calls: %d (shadows %d) | Triangles: %d",
+                renderer.getVisibleObjectCount(), renderer.getCulledObjectCount(), renderer.getDrawCallCount(),
+                renderer.getShadowDrawCount(), renderer.getTriangleCount()
+            );
+            ImGui::TextColored(
+                ImVec4(1, 1, 1, 0.7f),
+                "State changes: %d | Skipped: %d | Lights: %d (max %d per cluster)",
+                renderer.getStateChangeCount(), renderer.getSkippedStateChangeCount(),
+                renderer.getLightCount(), renderer.getMaxLightsPerCluster()
+            );
+            ImGui::TextColored(
+                ImVec4(1, 1, 1, 0.7f),
+                "Resolution: %.0f%% (%dx%d) | GPU: %.2f ms | Render targets: %d (%d allocations)",
+                renderer.getResolutionScale() * 100.0f, renderer.getRenderWidth(), renderer.getRenderHeight(),
+                renderer.getViewportGpuTime(), static_cast<int>(renderer.getRenderTargetCount()),
+                renderer.getRenderTargetAllocations()
+            );
+        }
+
         if (viewportController.isViewportFocused()) {
-            ImGui::SetCursorPos(ImVec2(10, 50));
             ImGui::TextColored(ImVec4(0.4f, 1.0f, 0.4f, 1.0f), "Camera Active");
         }
+        ImGui::EndGroup();
 
         bool windowFocused = ImGui::IsWindowFocused();
         viewportController.updateFocusFromImGui(windowFocused);
@@ -3187,79 +4864,112 @@ private:
     void addObject(ObjectType type, const std::string& baseName) {
         int id = nextObjectId++;
         std::string name = baseName + " " + std::to_string(id);
-        sceneObjects.push_back(SceneObject(name, type, id));
+        addSceneObject(id, name, type);
         selectedObjectId = id;
-        if (projectManager.currentProject.isLoaded) {
-            projectManager.currentProject.hasUnsavedChanges = true;
-        }
+        markSceneChanged();
         logToConsole("Created: " + name);
     }
 
     void duplicateSelected() {
-        auto it = std::find_if(sceneObjects.begin(), sceneObjects.end(),
-            [this](const SceneObject& obj) { return obj.id == selectedObjectId; });
+        Entity original = getSelectedEntity();
+        EntityWorld& world = sceneObjects.getWorld();
 
-        if (it != sceneObjects.end()) {
+        if (world.isAlive(original)) {
             int id = nextObjectId++;
-            SceneObject newObj(it->name + " (Copy)", it->type, id);
-            newObj.position = it->position + glm::vec3(1.0f, 0.0f, 0.0f);
-            newObj.rotation = it->rotation;
-            newObj.scale = it->scale;
+            const ObjectInfo& info = *world.get<ObjectInfo>(original);
+            std::string name = info.name + " (Copy)";
+            // A sibling of the original, offset in the parent's space
+            Entity copy = addSceneObject(id, name, info.type, sceneObjects.getParentId(original));
+
+            Transform& transform = *world.get<Transform>(copy);
+            const Transform& source = *world.get<Transform>(original);
+            transform.position = source.position + glm::vec3(1.0f, 0.0f, 0.0f);
+            transform.rotation = source.rotation;
+            transform.scale = source.scale;
+            syncTransform(copy);
+
             // Copy mesh data for OBJ meshes
-            newObj.meshPath = it->meshPath;
-            newObj.meshId = it->meshId;
-            
-            sceneObjects.push_back(newObj);
+            if (const MeshRef* mesh = world.get<MeshRef>(original)) world.get<MeshRef>(copy)->meshId = mesh->meshId;
+            if (const Light* light = world.get<Light>(original)) *world.get<Light>(copy) = *light;
+            if (const MeshFile* meshFile = world.get<MeshFile>(original)) world.add(copy, MeshFile(*meshFile));
+            if (world.has<StaticTag>(original)) world.add(copy, StaticTag());
+
             selectedObjectId = id;
-            if (projectManager.currentProject.isLoaded) {
-                projectManager.currentProject.hasUnsavedChanges = true;
-            }
-            logToConsole("Duplicated: " + newObj.name);
+            markSceneChanged();
+            logToConsole("Duplicated: " + name);
         }
     }
 
     void deleteSelected() {
-        auto it = std::remove_if(sceneObjects.begin(), sceneObjects.end(),
-            [this](const SceneObject& obj) { return obj.id == selectedObjectId; });
+        Entity entity = getSelectedEntity();
+        EntityWorld& world = sceneObjects.getWorld();
 
-        if (it != sceneObjects.end()) {
+        if (world.isAlive(entity)) {
             logToConsole("Deleted object");
-            sceneObjects.erase(it, sceneObjects.end());
-            selectedObjectId = -1;
-            if (projectManager.currentProject.isLoaded) {
-                projectManager.currentProject.hasUnsavedChanges = true;
+
+            // Children move up to the deleted object's parent and stay where they are
+            updateTransforms();
+            int id = selectedObjectId;
+            int parentId = sceneObjects.getParentId(entity);
+            int node = world.get<Transform>(entity)->node;
+            glm::mat4 toParent = glm::inverse(transforms.getParentWorldMatrix(node));
+            std::vector<int> childIds = sceneObjects.getChildIds(entity);
+            for (int childId : childIds) {
+                Entity child = sceneObjects.find(childId);
+                Transform* transform = world.get<Transform>(child);
+                if (!transform) continue;
+                TransformHierarchy::decompose(toParent * transforms.getWorldMatrix(transform->node),
+                                              transform->position, transform->rotation, transform->scale);
+                syncTransform(child);
+                sceneObjects.link(childId, parentId);
             }
+            sceneObjects.link(id, -1);
+            transforms.destroyNode(node);
+
+            const SpatialProxy* proxy = world.get<SpatialProxy>(entity);
+            if (proxy && proxy->node != AABBTree::NullNode) {
+                sceneTree.destroyProxy(proxy->node);
+            }
+            if (world.has<StaticTag>(entity)) renderer.invalidateStaticShadows();
+            size_t index = static_cast<size_t>(sceneObjects.indexOf(id));
+            sceneObjects.remove(id);
+            renderer.removeObjectState(index);
+            // Objects after the erased one shifted down; keep their proxies pointing at them
+            for (size_t i = index; i < sceneObjects.size(); i++) {
+                const SpatialProxy* shifted = world.get<SpatialProxy>(sceneObjects.entityAt(i));
+                if (shifted && shifted->node != AABBTree::NullNode) {
+                    sceneTree.setUserData(shifted->node, static_cast<int>(i));
+                }
+            }
+            selectedObjectId = -1;
+            markSceneChanged();
         }
     }
 
     void setParent(int childId, int parentId) {
-        auto childIt = std::find_if(sceneObjects.begin(), sceneObjects.end(),
-            [childId](const SceneObject& obj) { return obj.id == childId; });
-
-        if (childIt == sceneObjects.end()) return;
-
-        if (childIt->parentId != -1) {
-            auto oldParentIt = std::find_if(sceneObjects.begin(), sceneObjects.end(),
-                [&childIt](const SceneObject& obj) { return obj.id == childIt->parentId; });
-            if (oldParentIt != sceneObjects.end()) {
-                auto& children = oldParentIt->childIds;
-                children.erase(std::remove(children.begin(), children.end(), childId), children.end());
-            }
+        Entity child = sceneObjects.find(childId);
+        EntityWorld& world = sceneObjects.getWorld();
+        if (!world.isAlive(child)) return;
+        Entity parent = sceneObjects.find(parentId);
+        if (!world.isAlive(parent)) parentId = -1;
+
+        // Keep the object where it is in the world
+        updateTransforms();
+        Transform& transform = *world.get<Transform>(child);
+        int parentNode = parentId != -1 ? world.get<Transform>(parent)->node : TransformHierarchy::NullNode;
+        glm::mat4 worldMatrix = transforms.getWorldMatrix(transform.node);
+        if (!transforms.setParent(transform.node, parentNode)) {
+            addConsoleMessage("Can't parent an object to one of its own children", ConsoleMessageType::Warning);
+            return;
         }
+        glm::mat4 parentWorld = parentId != -1 ? transforms.getWorldMatrix(parentNode) : glm::mat4(1.0f);
+        TransformHierarchy::decompose(glm::inverse(parentWorld) * worldMatrix, transform.position, transform.rotation,
+                                      transform.scale);
+        syncTransform(child);
 
-        childIt->parentId = parentId;
+        sceneObjects.link(childId, parentId);
 
-        if (parentId != -1) {
-            auto newParentIt = std::find_if(sceneObjects.begin(), sceneObjects.end(),
-                [parentId](const SceneObject& obj) { return obj.id == parentId; });
-            if (newParentIt != sceneObjects.end()) {
-                newParentIt->childIds.push_back(childId);
-            }
-        }
-
-        if (projectManager.currentProject.isLoaded) {
-            projectManager.currentProject.hasUnsavedChanges = true;
-        }
+        markSceneChanged();
         logToConsole("Reparented object");
     }
 